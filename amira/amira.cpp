@@ -20,11 +20,13 @@
 #include <algorithm>
 #include <cerrno>
 #include <chrono>
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <set>
 #include <stdexcept>
@@ -44,18 +46,30 @@
 void usage(const char *binary, const int code) {
     std::cerr << binary << ": run AMIRA with a fixed sample size" << std::endl
         << "USAGE: " << binary
-        << " [-c] [-d dataset_size] [-fh] [-jnp] [-s sample] [-v] "
+        << " [-c] [-d dataset_size] [-e target_eps] [-fh] [-jnp] [-r reservoir] "
+        "[-m max_sample_size] [-s sample] [-t time_budget] [-v] "
         "failure_probability minimum_frequency sample_size dataset" << std::endl
         << "\t-c : print the closed frequent itemsets, rather than the "
         "frequent ones" << std::endl
+        << "\t-e : progressive sampling: double the sample, starting from "
+        "'sample_size', until eps is at most 'target_eps'" << std::endl
         << "\t-f : print full information about the run at the end" << std::endl
         << "\t-h : print this message and exit" << std::endl
         << "\t-i : ignore items with frequency less than 'ignore_frequency' "
         "when computing the bounds" << std::endl
         << "\t-j : print final output in JSON format" << std::endl
+        << "\t-m : progressive sampling: stop instead of doubling the sample "
+        "past 'max_sample_size' transactions (by default, past the largest "
+        "size that can be represented)" << std::endl
         << "\t-n : do not output the itemsets at the end" << std::endl
         << "\t-p : skip the computation of the second bound" << std::endl
+        << "\t-r : maintain the sample in file 'reservoir' across runs on an "
+        "append-only dataset, reading only the transactions appended since the "
+        "last run" << std::endl
         << "\t-s : write the sampled transactions to file 'sample'" << std::endl
+        << "\t-t : progressive sampling: double the sample, starting from "
+        "'sample_size', until 'time_budget' seconds have elapsed (or eps is "
+        "at most 'target_eps' with -e)" << std::endl
         << "\t-v : print log messages to stderr during the execution"
         << std::endl;
     std::exit(code);
@@ -69,11 +83,15 @@ int main(int argc, char** argv) {
     bool skipsecond {false};
     bool verbose {false};
     amira::count ds_size {0};
+    amira::count max_size {std::numeric_limits<amira::count>::max()};
+    double target_eps {0};
+    double time_budget {0};
     std::string outf;
+    std::string reservoir;
     char opt;
     extern char *optarg;
     extern int optind;
-    while ((opt = getopt(argc, argv, "cd:fhjnps:v")) != -1) {
+    while ((opt = getopt(argc, argv, "cd:e:fhjm:npr:s:t:v")) != -1) {
         switch (opt) {
             case 'c':
                 printclosed = true;
@@ -86,6 +104,14 @@ int main(int argc, char** argv) {
                     return EXIT_FAILURE;
                 }
                 break;
+            case 'e':
+                target_eps = std::strtod(optarg, NULL);
+                if (errno == ERANGE || target_eps <= 0) {
+                    std::cerr << "Error: target_eps must be a positive real"
+                        << std::endl;
+                    return EXIT_FAILURE;
+                }
+                break;
             case 'f':
                 full = true;
                 break;
@@ -95,15 +121,34 @@ int main(int argc, char** argv) {
             case 'j':
                 json = true;
                 break;
+            case 'm':
+                max_size = std::strtoul(optarg, NULL, 10);
+                if (errno == ERANGE || errno == EINVAL || max_size == 0) {
+                    std::cerr << "Error: max_sample_size must be a positive "
+                        "integer" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                break;
             case 'n':
                 noitmsets = true;
                 break;
             case 'p':
                 skipsecond = true;
                 break;
+            case 'r':
+                reservoir = std::string(optarg);
+                break;
             case 's':
                 outf = std::string(optarg);
                 break;
+            case 't':
+                time_budget = std::strtod(optarg, NULL);
+                if (errno == ERANGE || time_budget <= 0) {
+                    std::cerr << "Error: time_budget must be a positive real"
+                        << std::endl;
+                    return EXIT_FAILURE;
+                }
+                break;
             case 'v':
                 verbose = true;
                 break;
@@ -150,7 +195,20 @@ int main(int argc, char** argv) {
     //}
     const std::string dataset {argv[argc - 1]};
     const auto start {std::chrono::system_clock::now()};
-    if (ds_size == 0) {
+    if (! reservoir.empty() && ds_size != 0) {
+        std::cerr << "Error: -d cannot be used with -r" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (! reservoir.empty() && (target_eps > 0 || time_budget > 0)) {
+        std::cerr << "Error: -e and -t cannot be used with -r" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (size > max_size) {
+        std::cerr << "Error: max_sample_size must be at least samplesize"
+            << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (ds_size == 0 && reservoir.empty()) {
         if (verbose)
             std::cerr << "Getting dataset size...";
         try {
@@ -162,147 +220,213 @@ int main(int argc, char** argv) {
         if (verbose)
             std::cerr << "done (" << ds_size << " transactions)" << std::endl;
     }
-    if (verbose)
-        std::cerr << "Creating sample of size " << size << "...";
     // The unique sampled transactions, with the number of times they appear in
     // the sample.
     std::unordered_map<amira::itemset, amira::count, amira::ItemsetHash> sample;
     std::map<amira::item,amira::ItemsetInfo> item_infos;
-    // Create the sample and populate the item_infos data structure needed to
-    // compute the first omega and the first rho.
-    // XXX MR: Strictly speaking, in terms of running time, populating the data
-    // structure should probably be assigned to the time needed to compute
-    // omega1 and rho1, but implementation-wise, it is easier to populate the
-    // structure in create_sample.
-    try {
-        amira::create_sample(dataset, ds_size, size, sample, item_infos);
-    } catch (std::runtime_error &e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return EXIT_FAILURE;
-    }
-    const auto create_sample_end {std::chrono::system_clock::now()};
-    // Write the sample to an output file if requested.
-    if (! outf.empty()) {
+    // The CFIs of the sample, ordered according to <_q.
+    std::set<amira::ItemsetWithInfo, amira::SuppThenInvByLengthComp> q;
+    amira::AddItemsetToSet ftor {q};
+    amira::EraEps item_er; // stores omega1 and rho1
+    amira::EraEps itemset_er {0, 0}; // stores omega2 and rho2
+    double freq1, freq2, r;
+    amira::count supp1, supp, supp2 {0};
+    std::size_t cfis1;
+    // In progressive mode, the sample starts at the given size and is doubled
+    // after each round, until the bound 2*r to the maximum deviation reaches
+    // target_eps or time_budget is exceeded. The bounds of round i are computed
+    // with failure probability delta/2^i, so that, by a union bound over the
+    // rounds, the bound of the round at which the sampling stops holds with
+    // probability at least 1 - delta. The sample is never doubled past
+    // max_size, so the rounds also stop there.
+    const bool progressive {target_eps > 0 || time_budget > 0};
+    unsigned rounds {0};
+    // What stopped the rounds in progressive mode.
+    std::string_view stopped_by {"N/A"};
+    double round_delta {delta};
+    // Running times of the steps, summed over the rounds.
+    std::chrono::system_clock::duration create_sample_time {0};
+    std::chrono::system_clock::duration rho1_time {0};
+    std::chrono::system_clock::duration mine_time {0};
+    std::chrono::system_clock::duration rho2_time {0};
+    std::chrono::system_clock::duration prune_time {0};
+    auto step_start {start};
+    for (amira::count draws {size};;) {
+        ++rounds;
+        if (progressive) {
+            round_delta = delta / std::pow(2.0, rounds);
+            if (verbose)
+                std::cerr << "Round " << rounds << " (failure probability "
+                    << round_delta << ")" << std::endl;
+        }
         if (verbose)
-            std::cerr << "done" << std::endl << "Writing sample...";
+            std::cerr << "Creating sample of size " << size << "...";
+        // Create the sample, or add the new draws to it, and populate the
+        // item_infos data structure needed to compute the first omega and the
+        // first rho.
+        // XXX MR: Strictly speaking, in terms of running time, populating the
+        // data structure should probably be assigned to the time needed to
+        // compute omega1 and rho1, but implementation-wise, it is easier to
+        // populate the structure in create_sample.
         try {
-            amira::write_sample(sample, outf);
+            if (rounds > 1)
+                amira::extend_sample(dataset, ds_size, draws, sample,
+                        item_infos);
+            else if (reservoir.empty())
+                amira::create_sample(dataset, ds_size, size, sample,
+                        item_infos, progressive);
+            else
+                ds_size = amira::update_reservoir(dataset, reservoir, size,
+                        sample, item_infos);
         } catch (std::runtime_error &e) {
             std::cerr << "Error: " << e.what() << std::endl;
             return EXIT_FAILURE;
         }
-    }
-    if (verbose)
-        std::cerr << "done" << std::endl << "Computing omega1 and rho1...";
-    // Compute omega1 and rho1 using the item supports.
-    const auto rho1_start {std::chrono::system_clock::now()};
-    amira::EraEps item_er; // stores omega1 and rho1
-    try {
-        amira::compute_eraeps(delta, size, item_infos, item_er);
-    } catch (const std::runtime_error &e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return EXIT_FAILURE;
-    }
-    const auto rho1_end {std::chrono::system_clock::now()};
-    if (verbose)
-        std::cerr << "done (omega1: " << item_er.era << ", rho1: "
-            << item_er.eps << ")" << std::endl
-            << "Mining CFIs from the sample at frequency ";
-    // Compute the first lowered frequency and support thresholds.
-    double freq1 {theta - item_er.eps};
-    if (freq1 <= 0)
-        freq1 = 1.0 / size;
-    if (verbose)
-        std::cerr << freq1 << "...";
-    const amira::count supp1 {
-        static_cast<amira::count>(std::ceil(freq1 * size))};
-    // Mine the Closed Frequent Itemesets (CFIs) in the sample at the first
-    // lowered support threshold. The CFIs are stored in q, which is ordered
-    // according to <_q.
-    std::set<amira::ItemsetWithInfo, amira::SuppThenInvByLengthComp> q;
-    amira::AddItemsetToSet ftor {q};
-    amira::mine_sample(sample, supp1, item_infos, ftor);
-    const auto mine_end {std::chrono::system_clock::now()};
-    const auto cfis1 {q.size()};
-    if (verbose)
-        std::cerr << "done (" << cfis1  << " CFIs found)" << std::endl;
+        create_sample_time += std::chrono::system_clock::now() - step_start;
+        if (verbose)
+            std::cerr << "done" << std::endl << "Computing omega1 and rho1...";
+        // Compute omega1 and rho1 using the item supports.
+        step_start = std::chrono::system_clock::now();
+        try {
+            amira::compute_eraeps(round_delta, size, item_infos, item_er);
+        } catch (const std::runtime_error &e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        rho1_time += std::chrono::system_clock::now() - step_start;
+        if (verbose)
+            std::cerr << "done (omega1: " << item_er.era << ", rho1: "
+                << item_er.eps << ")" << std::endl
+                << "Mining CFIs from the sample at frequency ";
+        // Compute the first lowered frequency and support thresholds.
+        freq1 = theta - item_er.eps;
+        if (freq1 <= 0)
+            freq1 = 1.0 / size;
+        if (verbose)
+            std::cerr << freq1 << "...";
+        supp1 = static_cast<amira::count>(std::ceil(freq1 * size));
+        // Mine the Closed Frequent Itemesets (CFIs) in the sample at the first
+        // lowered support threshold. The FP-tree is built again in each round,
+        // because the order of the items and the items kept depend on the
+        // supports and on supp1.
+        step_start = std::chrono::system_clock::now();
+        q.clear();
+        amira::mine_sample(sample, supp1, item_infos, ftor);
+        mine_time += std::chrono::system_clock::now() - step_start;
+        cfis1 = q.size();
+        if (verbose)
+            std::cerr << "done (" << cfis1  << " CFIs found)" << std::endl;
 
-    amira::EraEps itemset_er; // stores omega2 and rho2
-    double r {item_er.eps};
-    double freq2 {freq1};
-    amira::count supp {supp1};
-    amira::count supp2;
-    auto rho2_end {std::chrono::system_clock::now()};
-    auto prune_end {std::chrono::system_clock::now()};
-    if (skipsecond)
-        goto output;
-    if (verbose)
-        std::cerr << "Computing omega2 and rho2...";
-    // Add to q the items that are not frequent wrt freq1
-    {
-        for (const auto &ii : item_infos)
-            if (ii.second.sp < supp1)
-                // We cannot reuse ii.second because its g and h are already
-                // populated, while we want ``vanilla' ones.
-                q.emplace(amira::itemset({ii.first}),
-                        amira::ItemsetInfo(ii.second.sp));
-    }
-    // Populate the infos of the itemsets in q: for each transaction t we find
-    // the itemset in t that appears first in q.
-    // XXX MR: An openMP for-loop would help here, but we need to figure out
-    // the reduction or maybe the locks, as we write into q.
-    for (const auto &p : sample) {
-        for (auto qit {q.begin()}; qit != q.end(); ++qit) {
-            // std::includes() requires consistent sorting between the
-            // elements in the two ranges. We sorted the items in each
-            // transaction at sample creation time and sorted the items
-            // in each element of q in impl::AddItemsetToSet while
-            // populating q.
-            // TODO: Is std::includes slow? Shall we try rolling our
-            // own using binary search?
-            if (const auto& cfi {*qit}; cfi.itms.size() <= p.first.size() &&
-                    std::includes(p.first.cbegin(), p.first.cend(),
-                        cfi.itms.cbegin(), cfi.itms.cend())) {
-                qit->info.update(p.first.size() - qit->itms.size(), p.second);
-                break;
+        r = item_er.eps;
+        freq2 = freq1;
+        supp = supp1;
+        if (! skipsecond) {
+            if (verbose)
+                std::cerr << "Computing omega2 and rho2...";
+            step_start = std::chrono::system_clock::now();
+            // Add to q the items that are not frequent wrt freq1
+            {
+                for (const auto &ii : item_infos)
+                    if (ii.second.sp < supp1)
+                        // We cannot reuse ii.second because its g and h are
+                        // already populated, while we want ``vanilla' ones.
+                        q.emplace(amira::itemset({ii.first}),
+                                amira::ItemsetInfo(ii.second.sp));
+            }
+            // Populate the infos of the itemsets in q: for each transaction t
+            // we find the itemset in t that appears first in q.
+            // XXX MR: An openMP for-loop would help here, but we need to
+            // figure out the reduction or maybe the locks, as we write into q.
+            for (const auto &p : sample) {
+                for (auto qit {q.begin()}; qit != q.end(); ++qit) {
+                    // std::includes() requires consistent sorting between the
+                    // elements in the two ranges. We sorted the items in each
+                    // transaction at sample creation time and sorted the items
+                    // in each element of q in impl::AddItemsetToSet while
+                    // populating q.
+                    // TODO: Is std::includes slow? Shall we try rolling our
+                    // own using binary search?
+                    if (const auto& cfi {*qit};
+                            cfi.itms.size() <= p.first.size() &&
+                            std::includes(p.first.cbegin(), p.first.cend(),
+                                cfi.itms.cbegin(), cfi.itms.cend())) {
+                        qit->info.update(p.first.size() - qit->itms.size(),
+                                p.second);
+                        break;
+                    }
+                }
+            }
+            // Compute omega2 and rho2
+            try {
+                const amira::count supp1_minus1 {supp1 - 1};
+                auto data {std::tie(supp1_minus1, std::as_const(q))};
+                amira::compute_eraeps(round_delta, size, data, itemset_er);
+            } catch (const std::runtime_error &e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return EXIT_FAILURE;
             }
+            // Compute the second lowered frequency and support thresholds.
+            freq2 = theta - itemset_er.eps;
+            if (freq2 <= 0)
+                freq2 = 1.0 / size;
+            supp2 = static_cast<amira::count>(std::ceil(freq2 * size));
+            if (itemset_er.eps < r) {
+                 r = itemset_er.eps;
+                 supp = supp2;
+            }
+            rho2_time += std::chrono::system_clock::now() - step_start;
+            if (verbose)
+                std::cerr << "done (omega2: " << itemset_er.era << ", rho2: "
+                    << itemset_er.eps << ")" << std::endl;
         }
+        if (! progressive)
+            break;
+        if (2 * r <= target_eps)
+            stopped_by = "target_eps";
+        else if (time_budget > 0 && std::chrono::duration<double>(
+                    std::chrono::system_clock::now() - start).count()
+                >= time_budget)
+            stopped_by = "time_budget";
+        else if (size > max_size - size) {
+            stopped_by = "max_sample_size";
+            if (verbose)
+                std::cerr << "eps " << 2 * r << " above the target, but the "
+                    "sample cannot be doubled past " << max_size << std::endl;
+        }
+        if (stopped_by != "N/A")
+            break;
+        if (verbose)
+            std::cerr << "eps " << 2 * r << " above the target, doubling the "
+                "sample" << std::endl;
+        // Double the sample in the next round.
+        step_start = std::chrono::system_clock::now();
+        draws = size;
+        size += draws;
     }
-    // Compute omega2 and rho2
-    try {
-        const amira::count supp1_minus1 {supp1 - 1};
-        auto data {std::tie(supp1_minus1, std::as_const(q))};
-        amira::compute_eraeps(delta, size, data, itemset_er);
-    } catch (const std::runtime_error &e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return EXIT_FAILURE;
-    }
-    // Compute the second lowered frequency and support thresholds.
-    freq2 = theta - itemset_er.eps;
-    if (freq2 <= 0)
-        freq2 = 1.0 / size;
-    supp2 = static_cast<amira::count>(std::ceil(freq2 * size));
-    if (itemset_er.eps < r) {
-         r = itemset_er.eps;
-         supp = supp2;
-    }
-    rho2_end = std::chrono::system_clock::now();
-    if (verbose)
-        std::cerr << "done (omega2: " << itemset_er.era << ", rho2: "
-            << itemset_er.eps << ")" << std::endl;
-    if (! noitmsets) {
+    if (! skipsecond && ! noitmsets) {
         if (verbose)
             std::cerr << "Pruning CFIs...";
         // Remove from q the itemsets with support less than supp.
+        step_start = std::chrono::system_clock::now();
         q.erase(q.begin(), q.upper_bound({{}, supp - 1}));
-    }
-    prune_end = std::chrono::system_clock::now();
-    if (verbose) {
-        if (! noitmsets)
+        prune_time = std::chrono::system_clock::now() - step_start;
+        if (verbose)
             std::cerr << "done (from " << cfis1 << " to " << q.size()
                 << " CFIs)" << std::endl;
     }
-output:
+    // Write the sample to an output file if requested.
+    if (! outf.empty()) {
+        if (verbose)
+            std::cerr << "Writing sample...";
+        try {
+            amira::write_sample(sample, outf);
+        } catch (std::runtime_error &e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (verbose)
+            std::cerr << "done" << std::endl;
+    }
     if (verbose)
         std::cerr << "Printing output and exiting. Goodbye." << std::endl;
     // Printing output
@@ -337,8 +461,15 @@ output:
             << tab << "dataset: " << quotes << dataset << quotes << comma
             << std::endl
             << tab << "samplesize: " << size << comma << std::endl
+            << tab << "dataset_size: " << ds_size << comma << std::endl
+            << tab << "reservoir: " << quotes
+            << ((reservoir.empty()) ? "N/A" : reservoir) << quotes << comma
+            << std::endl
             << tab << "minimum_frequency: " << theta << comma << std::endl
             << tab << "failure_probability: " << delta << comma << std::endl
+            << tab << "target_eps: " << target_eps << comma << std::endl
+            << tab << "time_budget: " << time_budget << comma << std::endl
+            << tab << "max_sample_size: " << max_size << comma << std::endl
             << tab << "printclosed: " << ((printclosed) ? 1 : 0) << comma
             << std::endl
             << tab << "skipsecond: " << ((skipsecond) ? 1 : 0) << comma
@@ -351,6 +482,11 @@ output:
                 << "run: {" << std::endl;
         } else
             std::cout << std::endl << "# Run" << std::endl;
+        std::cout << tab << "rounds: " << rounds << comma << std::endl;
+        std::cout << tab << "round_failure_probability: " << round_delta
+            << comma << std::endl;
+        std::cout << tab << "stopped_by: " << quotes << stopped_by << quotes
+            << comma << std::endl;
         std::cout << tab << "omega1: " << item_er.era << comma << std::endl;
         std::cout << tab << "rho1: " << item_er.eps << comma << std::endl;
         std::cout << tab << "freq1: " << freq1 << comma << std::endl;
@@ -373,26 +509,26 @@ output:
             std::cout << std::endl << "## Runtimes (ms)" << std::endl;
         std::cout << tab << tab << "total: " <<
             std::chrono::duration_cast<std::chrono::milliseconds>(
-                    // We remove the time taken to write the sample to an
-                    // output file.
-                    (prune_end - start) - (rho1_start - create_sample_end)
-                    ).count()
+                    // The time taken to write the sample to an output file is
+                    // not included.
+                    create_sample_time + rho1_time + mine_time + rho2_time +
+                    prune_time).count()
             << comma << std::endl
             << tab << tab << "create_sample: " <<
             std::chrono::duration_cast<std::chrono::milliseconds>(
-                    create_sample_end - start).count() << comma << std::endl
+                    create_sample_time).count() << comma << std::endl
             << tab << tab << "get_rho1: " <<
             std::chrono::duration_cast<std::chrono::milliseconds>(
-                    rho1_end - rho1_start).count() << comma << std::endl
+                    rho1_time).count() << comma << std::endl
             << tab << tab << "mine: " <<
             std::chrono::duration_cast<std::chrono::milliseconds>(
-                    mine_end - rho1_end).count() << std::endl
+                    mine_time).count() << std::endl
             << tab << tab << "get_rho2: " <<
             std::chrono::duration_cast<std::chrono::milliseconds>(
-                    rho2_end - mine_end).count() << std::endl
+                    rho2_time).count() << std::endl
             << tab << tab << "prune: " <<
             std::chrono::duration_cast<std::chrono::milliseconds>(
-                    prune_end - rho2_end).count() << std::endl;
+                    prune_time).count() << std::endl;
         if (json)
             std::cout << tab << "}"; // close runtimes.
     } // full
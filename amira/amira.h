@@ -52,6 +52,9 @@ constexpr std::string_view isuppmeta {"# isupp:"};
 constexpr std::string_view sizemeta {"# size:"};
 constexpr auto isuppmetalen {8};
 constexpr auto sizemetalen {7};
+// Byte offset in the dataset up to which a reservoir has been updated.
+constexpr std::string_view offsetmeta {"# offset:"};
+constexpr auto offsetmetalen {9};
 
 // Compute the number of transactions in a file, using the metadata info if
 // requested and found.
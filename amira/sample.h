@@ -23,14 +23,19 @@
 #include <algorithm>
 #include <cerrno>
 #include <cstddef>
+#include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <iterator>
+#include <numeric>
+#include <random>
 #include <set>
 #include <stdexcept>
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "wheelwright/matteoutils/Sampler.h"
@@ -42,71 +47,21 @@
 
 namespace amira {
 
-// Sample sample_size transactions with replacement from dataset, which has size
-// ds_size. Store in ``sample'' the unique sampled transactions together with
-// the number of times they appear in the sample. The sum of the values of
-// ``sample'' is sample_size.  The information infos needed for computing the
-// first error bounds are also populated.
-void create_sample(const std::string &dataset, const count ds_size,
-        const count sample_size,
-        std::unordered_map<itemset, count, ItemsetHash> &sample,
+// Populate the infos needed for computing the first error bounds from the
+// unique sampled transactions in ``sample'' and the number of times they appear
+// in the sample.
+void populate_infos(
+        const std::unordered_map<itemset, count, ItemsetHash> &sample,
         std::map<item,ItemsetInfo> &infos) {
-    {
-        std::ifstream ds {dataset};
-        if (ds.fail())
-            throw std::runtime_error(std::strerror(errno));
-        // indices (in the dataset) of the transactions to sample
-        std::vector<std::size_t> tosample_idxs;
-        if (sample_size != ds_size)
-            tosample_idxs = MatteoUtils::Sampler(
-                static_cast<std::size_t>(ds_size)).samples(sample_size);
-        else { // Consider the dataset as the sample.
-            tosample_idxs.resize(ds_size);
-            std::iota(tosample_idxs.begin(), tosample_idxs.end(), 0);
-        }
-        std::sort(tosample_idxs.begin(), tosample_idxs.end());
-        // index in the dataset of the transaction just read
-        std::size_t curr_idx {0};
-        auto idxsit {tosample_idxs.begin()};
-        for (std::string line; idxsit != tosample_idxs.cend() &&
-                std::getline(ds, line);) {
-            // Skip metadata lines.
-            if (line[0] == amira::meta)
-                continue;
-            // Go to the next transaction if the transaction just read should
-            // not be sampled.
-            if (curr_idx != *idxsit) {
-                ++curr_idx;
-                continue;
-            }
-            std::istringstream ls {line};
-            itemset t {std::istream_iterator<item>(ls),
-                std::istream_iterator<item>()};
-            // We sort the items in a transaction in alphabetical order because
-            // we need a consistent ordering of items in transactions and cfis
-            // to populate the itemset infos needed to compute omega2 and rho2.
-            std::sort(t.begin(), t.end());
-            count copies {0};
-            // Add the transaction to the sample (possibly multiple times).
-            do {
-                ++idxsit;
-                ++copies;
-            } while (idxsit != tosample_idxs.end() && curr_idx == *idxsit);
-            for (const auto i : t) {
-                if (const auto infit {infos.lower_bound(i)};
-                        infit == infos.end() || infit->first != i)
-                    infos.emplace_hint(infit, i, copies);
-                else
-                    infit->second.sp += copies;
-            }
-            if (auto it {sample.find(t)}; it == sample.cend())
-                sample.emplace(std::move(t), std::move(copies));
+    for (const auto &p : sample) {
+        for (const auto i : p.first) {
+            if (const auto infit {infos.lower_bound(i)};
+                    infit == infos.end() || infit->first != i)
+                infos.emplace_hint(infit, i, p.second);
             else
-                it->second += copies;
-            ++curr_idx;
+                infit->second.sp += p.second;
         }
     }
-    // Populate the infos of the items appearing in the sample.
     // The members g and h of the ItemsetInfo's in infos are only updated the
     // for each distinct transaction, because copies do not change the number of
     // closed itemsets.
@@ -125,6 +80,203 @@ void create_sample(const std::string &dataset, const count ds_size,
     }
 }
 
+// Add to ``sample'' the transactions of dataset whose indices are in
+// tosample_idxs, which must be sorted, as many times as they appear in it.
+void add_to_sample(const std::string &dataset,
+        const std::vector<std::size_t> &tosample_idxs,
+        std::unordered_map<itemset, count, ItemsetHash> &sample) {
+    std::ifstream ds {dataset};
+    if (ds.fail())
+        throw std::runtime_error(std::strerror(errno));
+    // index in the dataset of the transaction just read
+    std::size_t curr_idx {0};
+    auto idxsit {tosample_idxs.begin()};
+    for (std::string line; idxsit != tosample_idxs.cend() &&
+            std::getline(ds, line);) {
+        // Skip metadata lines.
+        if (line[0] == amira::meta)
+            continue;
+        // Go to the next transaction if the transaction just read should
+        // not be sampled.
+        if (curr_idx != *idxsit) {
+            ++curr_idx;
+            continue;
+        }
+        std::istringstream ls {line};
+        itemset t {std::istream_iterator<item>(ls),
+            std::istream_iterator<item>()};
+        // We sort the items in a transaction in alphabetical order because
+        // we need a consistent ordering of items in transactions and cfis
+        // to populate the itemset infos needed to compute omega2 and rho2.
+        std::sort(t.begin(), t.end());
+        count copies {0};
+        // Add the transaction to the sample (possibly multiple times).
+        do {
+            ++idxsit;
+            ++copies;
+        } while (idxsit != tosample_idxs.end() && curr_idx == *idxsit);
+        if (auto it {sample.find(t)}; it == sample.cend())
+            sample.emplace(std::move(t), std::move(copies));
+        else
+            it->second += copies;
+        ++curr_idx;
+    }
+}
+
+// Sample sample_size transactions with replacement from dataset, which has size
+// ds_size. Store in ``sample'' the unique sampled transactions together with
+// the number of times they appear in the sample. The sum of the values of
+// ``sample'' is sample_size.  The information infos needed for computing the
+// first error bounds are also populated. If sample_size is ds_size, the dataset
+// itself is taken as the sample, unless always_draw is true (a sample that
+// extend_sample will add draws to must be drawn with replacement throughout).
+void create_sample(const std::string &dataset, const count ds_size,
+        const count sample_size,
+        std::unordered_map<itemset, count, ItemsetHash> &sample,
+        std::map<item,ItemsetInfo> &infos, const bool always_draw = false) {
+    // indices (in the dataset) of the transactions to sample
+    std::vector<std::size_t> tosample_idxs;
+    if (sample_size != ds_size || always_draw)
+        tosample_idxs = MatteoUtils::Sampler(
+            static_cast<std::size_t>(ds_size)).samples(sample_size);
+    else { // Consider the dataset as the sample.
+        tosample_idxs.resize(ds_size);
+        std::iota(tosample_idxs.begin(), tosample_idxs.end(), 0);
+    }
+    std::sort(tosample_idxs.begin(), tosample_idxs.end());
+    add_to_sample(dataset, tosample_idxs, sample);
+    // Populate the infos of the items appearing in the sample.
+    populate_infos(sample, infos);
+}
+
+// Add draws transactions sampled with replacement from dataset, which has size
+// ds_size, to the sample created by create_sample, so that it is a sample of
+// the old size plus draws transactions. The infos are populated again, because
+// the order <_H, on which the members g and h depend, changes with the
+// supports.
+void extend_sample(const std::string &dataset, const count ds_size,
+        const count draws,
+        std::unordered_map<itemset, count, ItemsetHash> &sample,
+        std::map<item,ItemsetInfo> &infos) {
+    std::vector<std::size_t> tosample_idxs {MatteoUtils::Sampler(
+            static_cast<std::size_t>(ds_size)).samples(draws)};
+    std::sort(tosample_idxs.begin(), tosample_idxs.end());
+    add_to_sample(dataset, tosample_idxs, sample);
+    infos.clear();
+    populate_infos(sample, infos);
+}
+
+// Maintain a sample of sample_size transactions drawn with replacement from
+// dataset, which is an append-only log, in the file state. The state holds the
+// number of transactions and the byte offset of the dataset covered by the
+// sample, then the sampled transactions. Only the transactions appended to the
+// dataset since the state was written are read (all of them if there is no
+// state yet): each of them replaces every slot of the sample independently
+// with probability 1/n, where n is the number of transactions read so far, so
+// each slot stays uniformly distributed over the whole dataset. A last line
+// not terminated by a newline is left for the next update. The updated state
+// is written back, and ``sample'' and ``infos'' are populated as in
+// create_sample. Return the number of transactions in the dataset.
+count update_reservoir(const std::string &dataset, const std::string &state,
+        const count sample_size,
+        std::unordered_map<itemset, count, ItemsetHash> &sample,
+        std::map<item,ItemsetInfo> &infos) {
+    using entry = std::unordered_map<itemset, count, ItemsetHash>::value_type;
+    count ds_size {0};
+    std::streamoff offset {0};
+    // The transaction in each slot of the sample. Pointers to the elements of
+    // an unordered_map stay valid when it rehashes.
+    std::vector<entry*> slots(sample_size, nullptr);
+    if (std::ifstream st {state}; ! st.fail()) {
+        std::size_t slot {0};
+        for (std::string line; std::getline(st, line);) {
+            if (line[0] == amira::meta) {
+                if (line.find(sizemeta) == 0)
+                    ds_size = std::stoul(line.substr(sizemetalen));
+                else if (line.find(offsetmeta) == 0)
+                    offset = std::stoll(line.substr(offsetmetalen));
+                continue;
+            }
+            if (slot == sample_size)
+                throw std::runtime_error("the reservoir in " + state +
+                        " has a different sample size");
+            std::istringstream ls {line};
+            itemset t {std::istream_iterator<item>(ls),
+                std::istream_iterator<item>()};
+            std::sort(t.begin(), t.end());
+            auto it {sample.try_emplace(std::move(t), 0).first};
+            ++(it->second);
+            slots[slot++] = &(*it);
+        }
+        if (slot != sample_size)
+            throw std::runtime_error("the reservoir in " + state +
+                    " has a different sample size");
+    }
+    std::ifstream ds {dataset};
+    if (ds.fail())
+        throw std::runtime_error(std::strerror(errno));
+    ds.seekg(0, std::ios::end);
+    if (ds.tellg() < offset)
+        throw std::runtime_error(dataset + " is shorter than when the "
+                "reservoir was last updated");
+    ds.seekg(offset);
+    std::mt19937_64 prng {std::random_device {}()};
+    std::unordered_set<std::size_t> replaced;
+    for (std::string line; std::getline(ds, line);) {
+        // Leave a partially written transaction for the next update.
+        if (ds.eof())
+            break;
+        offset = ds.tellg();
+        // Skip metadata lines.
+        if (line[0] == amira::meta)
+            continue;
+        ++ds_size;
+        // Number of slots the transaction replaces, which are then chosen
+        // uniformly at random with Floyd's algorithm.
+        const count m {std::binomial_distribution<count>(sample_size,
+                1.0 / ds_size)(prng)};
+        if (m == 0)
+            continue;
+        replaced.clear();
+        for (auto j {sample_size - m}; j < sample_size; ++j) {
+            const auto r {std::uniform_int_distribution<std::size_t>(0,
+                    j)(prng)};
+            replaced.insert(replaced.count(r) ? j : r);
+        }
+        std::istringstream ls {line};
+        itemset t {std::istream_iterator<item>(ls),
+            std::istream_iterator<item>()};
+        std::sort(t.begin(), t.end());
+        auto it {sample.try_emplace(std::move(t), 0).first};
+        it->second += m;
+        for (const auto s : replaced) {
+            if (slots[s] != nullptr && --(slots[s]->second) == 0)
+                sample.erase(sample.find(slots[s]->first));
+            slots[s] = &(*it);
+        }
+    }
+    if (ds_size == 0)
+        throw std::runtime_error(dataset + " has no transactions");
+    // Write the state under a temporary name, so that the previous one stays
+    // valid until the new one is complete.
+    {
+        std::ofstream of {state + ".tmp"};
+        if (of.fail())
+            throw std::runtime_error(std::strerror(errno));
+        of << sizemeta << " " << ds_size << std::endl
+            << offsetmeta << " " << offset << std::endl;
+        for (const auto p : slots)
+            of << amira::write_container(p->first.cbegin(), p->first.cend())
+                << std::endl;
+        if (of.fail())
+            throw std::runtime_error(std::strerror(errno));
+    }
+    if (std::rename((state + ".tmp").c_str(), state.c_str()) != 0)
+        throw std::runtime_error(std::strerror(errno));
+    populate_infos(sample, infos);
+    return ds_size;
+}
+
 // Mine the closed frequent itemsets in the sample s at the minimum support
 // threshold thres, and call ftor on each of them.
 template<typename Ftor> void mine_sample(
@@ -0,0 +1,280 @@
+#ifndef _barnard_c_
+#define _barnard_c_
+
+/* BARNARD'S UNCONDITIONAL EXACT TEST
+ * Under the null hypothesis the cell counts are independent binomials A1 ~ Bin(n1,pi) and A0 ~ Bin(n0,pi), with
+ * the nuisance parameter pi unknown. The tables are ordered by the pooled score statistic
+ * 		Z(a1,a0) = (a1/n1 - a0/n0) / sqrt(p(1-p)(1/n1+1/n0)) , p = (a1+a0)/N
+ * and the p-value of a table is the supremum over pi of the probability of the tables with |Z| at least as large.
+ * Z does not depend on pi, and it increases with a1 and decreases with a0, so the rejection region is described by
+ * two thresholds per value of a1, computed once per table in O(N):
+ * 		Z(a1,a0) >= |z| iff a0 <= L[a1] , Z(a1,a0) <= -|z| iff a0 >= U[a1]
+ * The probability of the region at a given pi is then a single pass over a1 using the cumulative distributions of
+ * A0. The supremum is searched on a fixed grid of BARNARD_GRID_SIZE values of pi, whose probability mass functions
+ * are computed once and shared by all tables, and then refined around the maximisers, evaluating
+ * BARNARD_REFINE_POINTS values of pi at a time until the interval is shorter than BARNARD_PI_TOL. As the
+ * probability of the region may have several local maxima in pi, every local maximum of the grid is refined. Both
+ * stages evaluate their values of pi in parallel when compiled with OpenMP. Many hypotheses share the same table, so the p-values are kept in a
+ * direct-mapped cache of 2^BARNARD_CACHE_LOG2 entries.
+ * The probability mass functions are truncated where they underflow, so the cost of each value of pi is
+ * proportional to the spread of the binomials rather than to N.
+ *
+ * Needs the global variables N, n and loggamma, and must therefore be included after they are defined.
+ * */
+
+/* CODE DEPENDENCIES */
+#include<float.h>
+
+/* CONSTANT DEFINES */
+#ifndef BARNARD_GRID_SIZE
+#define BARNARD_GRID_SIZE 32 //Number of values of pi of the fixed grid
+#endif
+#ifndef BARNARD_REFINE_POINTS
+#define BARNARD_REFINE_POINTS 6 //Number of values of pi evaluated at each refinement step
+#endif
+#ifndef BARNARD_PI_TOL
+#define BARNARD_PI_TOL 1e-5 //Width of the interval of pi at which the refinement stops
+#endif
+#ifndef BARNARD_CACHE_LOG2
+#define BARNARD_CACHE_LOG2 20 //Base 2 logarithm of the number of entries of the cache of p-values
+#endif
+#define BARNARD_TIE_EPS 1e-10 //Relative tolerance to consider two values of the statistic tied
+
+/* TYPES */
+typedef struct {
+	double pi;
+	int lo1, hi1, lo0, hi0; // Cell counts of each class with non-zero probability
+	double *b1; // b1[a1-lo1] = P(A1 = a1)
+	double *F0, *S0; // F0[a0-lo0] = P(A0 <= a0), S0[a0-lo0] = P(A0 >= a0)
+} BARNARD_PMF;
+
+typedef struct {
+	int x, a; // Table of the entry, x = -1 if empty
+	double pval; // P-value, or a lower bound of it if the search stopped early
+	int complete; // Set to 1 if the search did not stop early
+} BARNARD_CACHE_ENTRY;
+
+/* GLOBAL VARIABLES */
+// Distributions of the fixed grid, and buffers for the values of pi of each refinement step
+BARNARD_PMF barnard_grid[BARNARD_GRID_SIZE], barnard_scratch[BARNARD_REFINE_POINTS];
+// Rejection region of the table being tested, as described above
+int *barnard_L, *barnard_U;
+// Inverse of the standard deviation of the numerator of Z for each margin x
+double *barnard_inv_sd;
+// Minimum attainable p-value of each margin x, negative until computed
+double *barnard_psi;
+// Cache of p-values
+BARNARD_CACHE_ENTRY *barnard_cache;
+
+/* CORE FUNCTIONS */
+
+// Logarithm of P(Bin(n_,pi) = k_)
+static inline double barnard_logpmf(int n_, int k_, double log_pi, double log_1_pi){
+	return (k_*log_pi) + ((n_-k_)*log_1_pi) + loggamma[n_] - loggamma[n_-k_] - loggamma[k_];
+}
+
+/* Compute the probabilities of Bin(n_,pi) which do not underflow into out, returning their range in lo and hi.
+ * The mass function is unimodal, so they form an interval around the mode, and are obtained from the probability
+ * of the mode with the ratios of consecutive probabilities
+ * */
+void barnard_binomial(int n_, double pi, double *out, int *lo, int *hi){
+	double r = pi/(1.0 - pi), b;
+	int k, mode;
+	mode = (int)((n_+1)*pi); if(mode > n_) mode = n_;
+	out[mode] = exp(barnard_logpmf(n_,mode,log(pi),log(1.0 - pi)));
+	for(k=mode, b=out[mode]; k<n_; k++){
+		if((b *= r*(n_-k)/(k+1)) < DBL_MIN) break;
+		out[k+1] = b;
+	}
+	*hi = k;
+	for(k=mode, b=out[mode]; k>0; k--){
+		if((b *= k/(r*(n_-k+1))) < DBL_MIN) break;
+		out[k-1] = b;
+	}
+	*lo = k;
+}
+
+/* Fill the distributions of P for the value pi. The arrays of P must hold n1+1 and n0+1 values */
+void barnard_pmf_fill(BARNARD_PMF *P, double pi){
+	int k, n0 = N-n;
+	double *b0 = P->F0;
+	P->pi = pi;
+	barnard_binomial(n,pi,P->b1,&P->lo1,&P->hi1);
+	if(P->lo1) memmove(P->b1,P->b1+P->lo1,(P->hi1-P->lo1+1)*sizeof(double));
+	// The probabilities of class 0 are computed in place of F0, and accumulated from both ends so that the
+	// smallest tails keep their relative precision
+	barnard_binomial(n0,pi,b0,&P->lo0,&P->hi0);
+	if(P->lo0) memmove(b0,b0+P->lo0,(P->hi0-P->lo0+1)*sizeof(double));
+	P->S0[P->hi0-P->lo0] = b0[P->hi0-P->lo0];
+	for(k=P->hi0-P->lo0-1; k>=0; k--) P->S0[k] = P->S0[k+1] + b0[k];
+	for(k=1; k<=P->hi0-P->lo0; k++) P->F0[k] += P->F0[k-1];
+}
+
+void barnard_pmf_alloc(BARNARD_PMF *P){
+	P->b1 = (double *)malloc((n+1)*sizeof(double));
+	P->F0 = (double *)malloc((N-n+1)*sizeof(double));
+	P->S0 = (double *)malloc((N-n+1)*sizeof(double));
+	if(!P->b1 || !P->F0 || !P->S0){
+		fprintf(stderr,"Error in function barnard_pmf_alloc: couldn't allocate memory for the distributions\n");
+		exit(1);
+	}
+}
+
+/* Copy the distributions of src into dst, allocating only their non-zero range */
+void barnard_pmf_copy(BARNARD_PMF *dst, BARNARD_PMF *src){
+	int m1 = src->hi1-src->lo1+1, m0 = src->hi0-src->lo0+1;
+	*dst = *src;
+	dst->b1 = (double *)malloc(m1*sizeof(double));
+	dst->F0 = (double *)malloc(m0*sizeof(double));
+	dst->S0 = (double *)malloc(m0*sizeof(double));
+	if(!dst->b1 || !dst->F0 || !dst->S0){
+		fprintf(stderr,"Error in function barnard_pmf_copy: couldn't allocate memory for the distributions\n");
+		exit(1);
+	}
+	memcpy(dst->b1,src->b1,m1*sizeof(double));
+	memcpy(dst->F0,src->F0,m0*sizeof(double));
+	memcpy(dst->S0,src->S0,m0*sizeof(double));
+}
+
+void barnard_pmf_free(BARNARD_PMF *P){
+	free(P->b1); free(P->F0); free(P->S0);
+}
+
+/* Probability of the rejection region in barnard_L and barnard_U under the distributions of P */
+double barnard_region_prob(BARNARD_PMF *P){
+	int a1, L, U, lo0 = P->lo0, hi0 = P->hi0;
+	double p = 0, t;
+	for(a1=P->lo1; a1<=P->hi1; a1++){
+		L = barnard_L[a1]; U = barnard_U[a1];
+		t = (L < lo0) ? 0 : P->F0[((L > hi0) ? hi0 : L) - lo0];
+		t += (U > hi0) ? 0 : P->S0[((U < lo0) ? lo0 : U) - lo0];
+		p += P->b1[a1-P->lo1]*t;
+	}
+	return p;
+}
+
+// Pooled score statistic of the table with cell counts a1 and a0
+static inline double barnard_z(int a1, int a0){
+	return (((double)a1)/n - ((double)a0)/(N-n))*barnard_inv_sd[a1+a0];
+}
+
+/* Compute the rejection region of the table with margin x and cell count a. Returns 0 if it contains all tables */
+int barnard_region(int x, int a){
+	int a1, L = -1, U = 0, n0 = N-n;
+	double z = fabs(barnard_z(a,x-a))*(1-BARNARD_TIE_EPS);
+	if(z <= 0) return 0;
+	// Both thresholds are non-decreasing in a1
+	for(a1=0; a1<=n; a1++){
+		while((L < n0) && (barnard_z(a1,L+1) >= z)) L++;
+		if(U < L+1) U = L+1;
+		while((U <= n0) && (barnard_z(a1,U) > -z)) U++;
+		barnard_L[a1] = L; barnard_U[a1] = U;
+	}
+	return 1;
+}
+
+/* Refine the maximum pmax, attained at pi_max, of the probability of the rejection region in the interval
+ * (left,right). Stops early once the maximum exceeds th
+ * */
+double barnard_refine(double left, double pi_max, double pmax, double right, double th){
+	double p[BARNARD_REFINE_POINTS], step;
+	int k;
+	while((pmax <= th) && (right-left > BARNARD_PI_TOL)){
+		step = (right-left)/(BARNARD_REFINE_POINTS+1);
+		#pragma omp parallel for
+		for(k=0; k<BARNARD_REFINE_POINTS; k++){
+			barnard_pmf_fill(&barnard_scratch[k],left+(k+1)*step);
+			p[k] = barnard_region_prob(&barnard_scratch[k]);
+		}
+		for(k=0; k<BARNARD_REFINE_POINTS; k++){
+			if(p[k] > pmax){ pmax = p[k]; pi_max = left+(k+1)*step; }
+		}
+		left = (pi_max-step > left) ? pi_max-step : left;
+		right = (pi_max+step < right) ? pi_max+step : right;
+	}
+	return pmax;
+}
+
+/* P-value of Barnard's test for the table with margin x and cell count a. The search stops as soon as a value of pi
+ * gives a probability larger than th, in which case the value returned is a lower bound of the p-value which is
+ * still larger than th (use th >= 1 to get the p-value itself)
+ * */
+double barnard_pval(int x, int a, double th){
+	double p[BARNARD_GRID_SIZE], pmax, left, right, pk;
+	int k;
+	BARNARD_CACHE_ENTRY *entry;
+
+	entry = barnard_cache + ((((unsigned long long)x)*(n+1)+a)*11400714819323198485ULL >> (64-BARNARD_CACHE_LOG2));
+	if((entry->x == x) && (entry->a == a) && (entry->complete || (entry->pval > th))) return entry->pval;
+	if(!barnard_region(x,a)) return 1;
+
+	// Fixed grid
+	#pragma omp parallel for
+	for(k=0; k<BARNARD_GRID_SIZE; k++) p[k] = barnard_region_prob(&barnard_grid[k]);
+
+	// The probability of the region may have several local maxima in pi, so all those of the grid are refined
+	pmax = 0;
+	for(k=0; (k<BARNARD_GRID_SIZE) && (pmax <= th); k++){
+		if(((k > 0) && (p[k] < p[k-1])) || ((k < BARNARD_GRID_SIZE-1) && (p[k] <= p[k+1]))) continue;
+		left = (k > 0) ? barnard_grid[k-1].pi : 0;
+		right = (k < BARNARD_GRID_SIZE-1) ? barnard_grid[k+1].pi : 1;
+		pk = barnard_refine(left,barnard_grid[k].pi,p[k],right,th);
+		if(pk > pmax) pmax = pk;
+	}
+	if(pmax > 1) pmax = 1;
+	entry->x = x; entry->a = a; entry->pval = pmax; entry->complete = (pmax <= th);
+	return pmax;
+}
+
+/* Minimum attainable p-value of margin x, attained at one of the two extreme cell counts since Z increases with the
+ * cell count when the margin is fixed
+ * */
+double barnard_min_pval(int x){
+	double p_left, p_right;
+	if(barnard_psi[x] < 0){
+		p_left = barnard_pval(x,((n+x-N) > 0) ? (n+x-N) : 0,1);
+		p_right = barnard_pval(x,(x > n) ? n : x,1);
+		barnard_psi[x] = (p_left < p_right) ? p_left : p_right;
+	}
+	return barnard_psi[x];
+}
+
+/* INITIALISATION AND TERMINATION FUNCTIONS */
+
+/* Must be called after loggamma_init */
+void barnard_init(){
+	int k;
+	barnard_L = (int *)malloc((n+1)*sizeof(int));
+	barnard_U = (int *)malloc((n+1)*sizeof(int));
+	barnard_psi = (double *)malloc((N+1)*sizeof(double));
+	barnard_inv_sd = (double *)malloc((N+1)*sizeof(double));
+	if(!barnard_L || !barnard_U || !barnard_psi || !barnard_inv_sd){
+		fprintf(stderr,"Error in function barnard_init: couldn't allocate memory for the arrays of the rejection regions\n");
+		exit(1);
+	}
+	for(k=0; k<=N; k++) barnard_psi[k] = -1;
+	// Z = 0 for the tables with margin 0 or N
+	barnard_inv_sd[0] = barnard_inv_sd[N] = 0;
+	for(k=1; k<N; k++) barnard_inv_sd[k] = 1/sqrt((((double)k)/N)*(1-((double)k)/N)*(1.0/n + 1.0/(N-n)));
+	barnard_cache = (BARNARD_CACHE_ENTRY *)malloc((1ULL << BARNARD_CACHE_LOG2)*sizeof(BARNARD_CACHE_ENTRY));
+	if(!barnard_cache){
+		fprintf(stderr,"Error in function barnard_init: couldn't allocate memory for array barnard_cache\n");
+		exit(1);
+	}
+	for(k=0; k<(1 << BARNARD_CACHE_LOG2); k++) barnard_cache[k].x = -1;
+	for(k=0; k<BARNARD_REFINE_POINTS; k++) barnard_pmf_alloc(&barnard_scratch[k]);
+	// The distributions of the grid keep only their non-zero range
+	for(k=0; k<BARNARD_GRID_SIZE; k++){
+		barnard_pmf_fill(&barnard_scratch[0],((double)(k+1))/(BARNARD_GRID_SIZE+1));
+		barnard_pmf_copy(&barnard_grid[k],&barnard_scratch[0]);
+	}
+}
+
+void barnard_end(){
+	int k;
+	for(k=0; k<BARNARD_GRID_SIZE; k++) barnard_pmf_free(&barnard_grid[k]);
+	for(k=0; k<BARNARD_REFINE_POINTS; k++) barnard_pmf_free(&barnard_scratch[k]);
+	free(barnard_L); free(barnard_U); free(barnard_psi); free(barnard_inv_sd); free(barnard_cache);
+}
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef _fisher_pval_table_c_
+#define _fisher_pval_table_c_
+
+/* PER-MARGIN TABLES OF FISHER'S EXACT TEST P-VALUES
+ * For a given margin x, the two-tailed p-values of all attainable cell counts a in [max(0,n+x-N),min(x,n)] are
+ * obtained with a single walk of the hypergeometric distribution from both tails, which accepts the tables from the
+ * least likely to the most likely one: the smaller of the two tail probabilities is accepted first, both when they
+ * are equal, and the p-value of a cell count is the sum of the probabilities accepted up to it. The walk of each
+ * margin is resumed only as far as the cell counts queried so far require, so that every test of an already accepted
+ * cell count is a single array read and no step of the walk is done twice. The least recently used tables are evicted once their total size
+ * exceeds PVAL_TABLE_MAX_MB megabytes.
+ *
+ * Needs the global variables N, n, loggamma and log_inv_binom_N_n and the function sumlogs, and must therefore
+ * be included after they are defined.
+ * */
+
+/* CONSTANT DEFINES */
+#ifndef PVAL_TABLE_MAX_MB
+#define PVAL_TABLE_MAX_MB 256 //Maximum memory used by the tables, in megabytes
+#endif
+
+/* TYPES */
+typedef struct {
+	double *pval; // pval[a-a_min] = p-value of cell count a, NULL if the table is not in memory
+	int a_min; // Smallest attainable cell count
+	int lo, hi; // Cell counts in [lo,hi] have not been accepted by the walk yet
+	double log_pval; // Logarithm of the probability accumulated by the walk so far
+	int prev, next; // Neighbours in the LRU list, -1 at its ends
+} PVAL_TABLE;
+
+/* GLOBAL VARIABLES */
+// One table per margin x in [0,N]
+PVAL_TABLE *pval_tables;
+// Most and least recently used margins, -1 if no table is in memory
+int pval_lru_head, pval_lru_tail;
+// Total number of p-values stored in the tables, and its maximum
+size_t pval_tables_siz, pval_tables_max_siz;
+
+/* INITIALISATION AND TERMINATION FUNCTIONS */
+
+void pval_tables_init(){
+	int x;
+	pval_tables = (PVAL_TABLE *)malloc((N+1)*sizeof(PVAL_TABLE));
+	if(!pval_tables){
+		fprintf(stderr,"Error in function pval_tables_init: couldn't allocate memory for array pval_tables\n");
+		exit(1);
+	}
+	for(x=0; x<=N; x++){ pval_tables[x].pval = ((double *)0); pval_tables[x].prev = pval_tables[x].next = -1; }
+	pval_lru_head = pval_lru_tail = -1;
+	pval_tables_siz = 0;
+	pval_tables_max_siz = ((size_t)PVAL_TABLE_MAX_MB)*1048576/sizeof(double);
+}
+
+void pval_tables_end(){
+	int x;
+	for(x=0; x<=N; x++) free(pval_tables[x].pval);
+	free(pval_tables);
+}
+
+/* LRU LIST FUNCTIONS */
+
+void pval_lru_unlink(int x){
+	if(pval_tables[x].prev >= 0) pval_tables[pval_tables[x].prev].next = pval_tables[x].next;
+	else pval_lru_head = pval_tables[x].next;
+	if(pval_tables[x].next >= 0) pval_tables[pval_tables[x].next].prev = pval_tables[x].prev;
+	else pval_lru_tail = pval_tables[x].prev;
+}
+
+void pval_lru_push_front(int x){
+	pval_tables[x].prev = -1;
+	pval_tables[x].next = pval_lru_head;
+	if(pval_lru_head >= 0) pval_tables[pval_lru_head].prev = x;
+	else pval_lru_tail = x;
+	pval_lru_head = x;
+}
+
+/* CORE FUNCTIONS */
+
+/* Allocate the table of margin x, evicting the least recently used tables if needed */
+void pval_table_alloc(int x){
+	int a_min, a_max, x_lru;
+	double *T;
+
+	a_min = ((n+x-N) > 0) ? (n+x-N) : 0;//max(0,n+x-N)
+	a_max = (x > n) ? n : x;//min(x,n)
+
+	// Make room for the new table
+	while((pval_lru_tail >= 0) && (pval_tables_siz + (a_max-a_min+1) > pval_tables_max_siz)){
+		x_lru = pval_lru_tail;
+		pval_lru_unlink(x_lru);
+		pval_tables_siz -= ((x_lru > n) ? n : x_lru) - pval_tables[x_lru].a_min + 1;
+		free(pval_tables[x_lru].pval);
+		pval_tables[x_lru].pval = ((double *)0);
+	}
+	T = (double *)malloc((a_max-a_min+1)*sizeof(double));
+	if(!T){
+		fprintf(stderr,"Error in function pval_table_alloc: couldn't allocate memory for array T\n");
+		exit(1);
+	}
+	pval_tables[x].pval = T; pval_tables[x].a_min = a_min;
+	pval_tables[x].lo = a_min; pval_tables[x].hi = a_max;
+	pval_tables[x].log_pval = -999999999;
+	pval_tables_siz += a_max-a_min+1;
+	pval_lru_push_front(x);
+}
+
+/* Resume the walk of margin x until cell count a has been accepted */
+void pval_table_walk(int a, int x){
+	int lo, hi, a_min;
+	double p_left, p_right, pval, pre_comp_xterms, *T;
+
+	// Walk from both tails, recording the p-value of each cell count when it is accepted
+	T = pval_tables[x].pval; a_min = pval_tables[x].a_min;
+	lo = pval_tables[x].lo; hi = pval_tables[x].hi;
+	pval = pval_tables[x].log_pval;
+	pre_comp_xterms = loggamma[x] + loggamma[N-x];
+	while((lo<hi) && (a>=lo) && (a<=hi)){
+		p_left = (pre_comp_xterms + log_inv_binom_N_n - (loggamma[lo] + loggamma[n-lo] + loggamma[x-lo] + loggamma[(N-n)-(x-lo)]));
+		p_right = (pre_comp_xterms + log_inv_binom_N_n - (loggamma[hi] + loggamma[n-hi] + loggamma[x-hi] + loggamma[(N-n)-(x-hi)]));
+		if(p_left == p_right){
+			pval = sumlogs(pval , p_left);
+			pval = sumlogs(pval , p_right);
+			T[lo-a_min] = T[hi-a_min] = exp(pval);
+			lo++; hi--;
+		}
+		else if(p_left < p_right){
+			pval = sumlogs(pval , p_left);
+			T[lo-a_min] = exp(pval);
+			lo++;
+		}
+		else{
+			pval = sumlogs(pval , p_right);
+			T[hi-a_min] = exp(pval);
+			hi--;
+		}
+	}
+	// The mode of the distribution has p-value 1
+	if(lo == hi) T[lo-a_min] = 1;
+	pval_tables[x].lo = lo; pval_tables[x].hi = hi;
+	pval_tables[x].log_pval = pval;
+}
+
+/* Two-tailed p-value of Fisher's exact test on a table with margins x, n and N and cell count a (not its logarithm) */
+double fisher_pval_table(int a, int x){
+	if(!pval_tables[x].pval) pval_table_alloc(x);
+	else if(pval_lru_head != x){
+		pval_lru_unlink(x);
+		pval_lru_push_front(x);
+	}
+	if((a >= pval_tables[x].lo) && (a <= pval_tables[x].hi)) pval_table_walk(a,x);
+	return pval_tables[x].pval[a-pval_tables[x].a_min];
+}
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef _stat_tests_c_
+#define _stat_tests_c_
+
+/* ADDITIONAL STATISTICAL TESTS
+ * Besides the test of the program itself (Fisher's exact test in fisher/, the unconditional test in unconditional/),
+ * the enumeration can evaluate other tests in the same traversal. They are called on every closed itemset visited by
+ * LCM, before the main test discards the ones it cannot test, so the hypotheses they see only depend on the minimum
+ * support given to the enumeration: to compare two tests, run it at the lower of their two minimum supports. Each
+ * test is a backend made of three functions:
+ * 		<name>_min_attainable(x) = minimum attainable p-value of a table with margin x
+ * 		<name>_pvalue(x,a) = p-value of the table with margin x and cell count a
+ * 		<name>_decide(x,a,th) = 1 if the table is significant at level th
+ * The backends are selected at compile time with -DSTAT_TEST_FISHER, -DSTAT_TEST_CHI2, -DSTAT_TEST_GTEST and
+ * -DSTAT_TEST_BARNARD (best compiled with -fopenmp, see barnard.c), and
+ * FOR_EACH_STAT_TEST expands into direct calls to the selected ones, so there are no indirect calls.
+ * Each selected test has its own significance threshold, given with the optional argument -delta_<name> (the
+ * corrected significance threshold of the main test by default). A hypothesis significant for any of them is
+ * written to <output_basefilename>_tests_pvalues.txt, with one p-value column per test, and to
+ * <output_basefilename>_tests_itemsets.txt.
+ * */
+
+/* CODE DEPENDENCIES */
+#include"stat_tests.h"
+
+/* BACKENDS */
+
+// Fisher's exact test, read from the per-margin tables of fisher_pval_table.c
+#ifdef STAT_TEST_FISHER
+#include"fisher_pval_table.c"
+
+static inline double fisher_pvalue(int x, int a){
+	return fisher_pval_table(a,x);
+}
+
+// The p-value is minimum at one of the two extreme cell counts
+static inline double fisher_min_attainable(int x){
+	double p_left = fisher_pval_table(((n+x-N) > 0) ? (n+x-N) : 0,x);
+	double p_right = fisher_pval_table((x > n) ? n : x,x);
+	return (p_left < p_right) ? p_left : p_right;
+}
+
+// Untestable margins are discarded before walking the tables
+static inline int fisher_decide(int x, int a, double th){
+	return (fisher_min_attainable(x) <= th) && (fisher_pvalue(x,a) <= th);
+}
+#endif
+
+// Pearson's chi-square test (1 degree of freedom, no continuity correction)
+#ifdef STAT_TEST_CHI2
+static inline double chi2_pvalue(int x, int a){
+	double num, stat;
+	if((x == 0) || (x == N)) return 1;
+	num = ((double)a)*((N-n)-(x-a)) - ((double)(x-a))*(n-a);
+	stat = ((double)N)*num*num/(((double)n)*(N-n)*((double)x)*(N-x));
+	return erfc(sqrt(stat/2));
+}
+
+static inline double chi2_min_attainable(int x){
+	double p_left = chi2_pvalue(x,((n+x-N) > 0) ? (n+x-N) : 0);
+	double p_right = chi2_pvalue(x,(x > n) ? n : x);
+	return (p_left < p_right) ? p_left : p_right;
+}
+
+// A closed form, so the p-value itself is the cheapest check
+static inline int chi2_decide(int x, int a, double th){
+	return chi2_pvalue(x,a) <= th;
+}
+#endif
+
+// Likelihood-ratio G-test (1 degree of freedom)
+#ifdef STAT_TEST_GTEST
+// Contribution of a cell with observed count o and expected count e
+static inline double gtest_term(double o, double e){
+	return (o > 0) ? o*log(o/e) : 0;
+}
+
+static inline double gtest_pvalue(int x, int a){
+	double G;
+	if((x == 0) || (x == N)) return 1;
+	G = 2*(gtest_term(a,((double)x)*n/N) + gtest_term(x-a,((double)x)*(N-n)/N)
+		+ gtest_term(n-a,((double)(N-x))*n/N) + gtest_term((N-n)-(x-a),((double)(N-x))*(N-n)/N));
+	// G is non-negative, up to rounding errors
+	return (G > 0) ? erfc(sqrt(G/2)) : 1;
+}
+
+static inline double gtest_min_attainable(int x){
+	double p_left = gtest_pvalue(x,((n+x-N) > 0) ? (n+x-N) : 0);
+	double p_right = gtest_pvalue(x,(x > n) ? n : x);
+	return (p_left < p_right) ? p_left : p_right;
+}
+
+static inline int gtest_decide(int x, int a, double th){
+	return gtest_pvalue(x,a) <= th;
+}
+#endif
+
+// Barnard's unconditional exact test
+#ifdef STAT_TEST_BARNARD
+#include"barnard.c"
+
+static inline double barnard_pvalue(int x, int a){
+	return barnard_pval(x,a,1);
+}
+
+// Cached for each margin, as it requires two p-value computations
+static inline double barnard_min_attainable(int x){
+	return barnard_min_pval(x);
+}
+
+// The search for the supremum over pi stops as soon as it exceeds the threshold
+static inline int barnard_decide(int x, int a, double th){
+	return (barnard_min_attainable(x) <= th) && (barnard_pval(x,a,th) <= th);
+}
+#endif
+
+#ifdef STAT_TESTS
+/* GLOBAL VARIABLES */
+// Significance threshold of each test (negative until set) and number of significant hypotheses found
+#define STAT_TEST_GLOBALS(name) double name##_th = -1; unsigned long name##_n_significant = 0;
+FOR_EACH_STAT_TEST(STAT_TEST_GLOBALS)
+// Output files
+FILE *tests_pvalues_output_file, *tests_itemsets_output_file;
+// Set to 1 if the Fisher tables were allocated here rather than by the main test
+int stat_tests_own_pval_tables = 0;
+
+/* INITIALISATION AND TERMINATION FUNCTIONS */
+
+/* Parse an optional argument -delta_<name> value of main. Returns 1 if the argument was consumed */
+int stat_tests_option(char *arg, char *value){
+	#define STAT_TEST_OPTION(name) if(!strcmp(arg,"-delta_" #name)){ name##_th = atof(value); return 1; }
+	FOR_EACH_STAT_TEST(STAT_TEST_OPTION)
+	return 0;
+}
+
+/* Create the output files, output_basefilename being the first argument of main */
+void stat_tests_open(char *output_basefilename){
+	char *tmp_filename;
+	tmp_filename = (char *)malloc((strlen(output_basefilename)+512)*sizeof(char));
+	if(!tmp_filename){
+		fprintf(stderr,"Error in function stat_tests_open: couldn't allocate memory for array tmp_filename\n");
+		exit(1);
+	}
+	strcpy(tmp_filename,output_basefilename); strcat(tmp_filename,"_tests_itemsets.txt");
+	if(!(tests_itemsets_output_file = fopen(tmp_filename,CHECKPOINT_FOPEN_MODE))){
+		fprintf(stderr, "Error in function stat_tests_open when opening file %s\n",tmp_filename);
+		exit(1);
+	}
+	strcpy(tmp_filename,output_basefilename); strcat(tmp_filename,"_tests_pvalues.txt");
+	if(!(tests_pvalues_output_file = fopen(tmp_filename,CHECKPOINT_FOPEN_MODE))){
+		fprintf(stderr, "Error in function stat_tests_open when opening file %s\n",tmp_filename);
+		exit(1);
+	}
+	free(tmp_filename);
+	// File header, one column per test
+	fprintf(tests_pvalues_output_file,"a1,a0,x");
+	#define STAT_TEST_HEADER(name) fprintf(tests_pvalues_output_file,",pvalue_" #name);
+	FOR_EACH_STAT_TEST(STAT_TEST_HEADER)
+	fprintf(tests_pvalues_output_file,"\n");
+}
+
+/* Set the default thresholds once the corrected significance threshold of the main test is known. Must be called
+ * after loggamma_init
+ * */
+void stat_tests_init(double sig_th){
+	#define STAT_TEST_DEFAULT_TH(name) if(name##_th < 0) name##_th = sig_th;
+	FOR_EACH_STAT_TEST(STAT_TEST_DEFAULT_TH)
+	#ifdef STAT_TEST_FISHER
+	if(!pval_tables){
+		pval_tables_init();
+		stat_tests_own_pval_tables = 1;
+	}
+	#endif
+	#ifdef STAT_TEST_BARNARD
+	barnard_init();
+	#endif
+}
+
+/* Report the number of hypotheses significant for each test, and close the output files */
+void stat_tests_end(){
+	#define STAT_TEST_REPORT(name) fprintf(results_file,"\t Number of significant patterns found by test " #name " at threshold %e: %lu\n",name##_th,name##_n_significant);
+	FOR_EACH_STAT_TEST(STAT_TEST_REPORT)
+	#ifdef STAT_TEST_FISHER
+	if(stat_tests_own_pval_tables) pval_tables_end();
+	#endif
+	#ifdef STAT_TEST_BARNARD
+	barnard_end();
+	#endif
+	fclose(tests_pvalues_output_file);
+	fclose(tests_itemsets_output_file);
+}
+
+/* Save or restore the counters and the lengths of the output files (checkpoint.c) */
+void stat_tests_checkpoint(){
+	#define STAT_TEST_CHECKPOINT(name) checkpoint_data(&name##_n_significant,sizeof(name##_n_significant));
+	FOR_EACH_STAT_TEST(STAT_TEST_CHECKPOINT)
+	checkpoint_output_file(tests_itemsets_output_file);
+	checkpoint_output_file(tests_pvalues_output_file);
+}
+
+/* CORE FUNCTIONS */
+
+/* Evaluate all selected tests on a hypothesis visited by the traversal, with margin x and cell count a */
+void stat_tests_process(int x, int a){
+	int i, significant = 0;
+	#define STAT_TEST_DECIDE(name) if(name##_decide(x,a,name##_th)){ name##_n_significant++; significant = 1; }
+	FOR_EACH_STAT_TEST(STAT_TEST_DECIDE)
+	if(!significant) return;
+
+	fprintf(tests_pvalues_output_file,"%d,%d,%d",a,x-a,x);
+	#define STAT_TEST_COLUMN(name) fprintf(tests_pvalues_output_file,",%e",name##_pvalue(x,a));
+	FOR_EACH_STAT_TEST(STAT_TEST_COLUMN)
+	fprintf(tests_pvalues_output_file,"\n");
+	for(i=0; i<LCM_itemsett; i++) fprintf(tests_itemsets_output_file,"%d ",FASTO_perm[current_itemset[i]]);
+	fprintf(tests_itemsets_output_file,"(%d)\n",LCM_frq);
+}
+#endif
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef _stat_tests_h_
+#define _stat_tests_h_
+
+/* Selection of the additional statistical tests, see stat_tests.c */
+
+/* COMPILE-TIME SELECTION OF THE BACKENDS */
+#ifdef STAT_TEST_FISHER
+#define STAT_TEST_FISHER_ENTRY(X) X(fisher)
+#else
+#define STAT_TEST_FISHER_ENTRY(X)
+#endif
+#ifdef STAT_TEST_CHI2
+#define STAT_TEST_CHI2_ENTRY(X) X(chi2)
+#else
+#define STAT_TEST_CHI2_ENTRY(X)
+#endif
+#ifdef STAT_TEST_GTEST
+#define STAT_TEST_GTEST_ENTRY(X) X(gtest)
+#else
+#define STAT_TEST_GTEST_ENTRY(X)
+#endif
+#ifdef STAT_TEST_BARNARD
+#define STAT_TEST_BARNARD_ENTRY(X) X(barnard)
+#else
+#define STAT_TEST_BARNARD_ENTRY(X)
+#endif
+#define FOR_EACH_STAT_TEST(X) STAT_TEST_FISHER_ENTRY(X) STAT_TEST_CHI2_ENTRY(X) STAT_TEST_GTEST_ENTRY(X) STAT_TEST_BARNARD_ENTRY(X)
+
+#if defined(STAT_TEST_FISHER) || defined(STAT_TEST_CHI2) || defined(STAT_TEST_GTEST) || defined(STAT_TEST_BARNARD)
+#define STAT_TESTS
+#endif
+
+#ifdef STAT_TESTS
+/* FUNCTION DECLARATIONS */
+int stat_tests_option(char *, char *);
+void stat_tests_open(char *);
+void stat_tests_init(double);
+void stat_tests_end();
+void stat_tests_process(int, int);
+#endif
+
+#endif
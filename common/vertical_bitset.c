@@ -0,0 +1,305 @@
+#ifndef _vertical_bitset_c_
+#define _vertical_bitset_c_
+
+/* VERTICAL BITSET ENGINE
+ * Alternative to LCMclosed() for dense datasets, selected with the optional argument -vertical.
+ * Each frequent item keeps the set of (non-empty) original transactions containing it as a bitset of
+ * 64-bit words. Closed itemsets are enumerated by prefix-preserving closure extension, as in LCM, with
+ * the tidset of an extension obtained as an AND of two bitsets. The margin x and the cell count a of each
+ * closed itemset are then popcount(tidset) and popcount(tidset & labels), computed in the same loop.
+ * The tidsets take LCM_Eend*Neff/8 bytes, so this engine only pays off on datasets with few items.
+ * Class labels of random permutations can be attached with VBS_perm_init/VBS_perm_set, in which case
+ * VBS_perm_counts gives the cell counts of the current solution in all permutations at once.
+ * */
+
+/* CODE DEPENDENCIES */
+#include"var_declare.h"
+#include"transaction_keeping.c"
+#include"lcm_var.c"
+
+/* TYPES AND MACROS */
+typedef unsigned long long VBS_WORD;
+#define VBS_WORD_BITS 64
+#define VBS_POPCOUNT(w) __builtin_popcountll(w)
+
+/* GLOBAL VARIABLES */
+// Set to 1 by the optional argument -vertical
+int use_vertical_engine = 0;
+// Number of words of each bitset
+int VBS_words;
+// Bitsets of all items, VBS_tid + e*VBS_words is the tidset of item e
+VBS_WORD *VBS_tid;
+// Bitset of the transactions in the positive class, NULL if the cell counts are not needed
+VBS_WORD *VBS_lab;
+// Tidsets of the itemsets in the current branch of the search tree (one per depth)
+VBS_WORD *VBS_stack;
+// Support of each item
+int *VBS_frq;
+// VBS_in[e] = 1 if item e belongs to the current itemset
+char *VBS_in;
+// Items of the current itemset, in the order they were added
+int *VBS_items, VBS_itemst;
+// Tidset of the solution being processed, with its first and last non-zero words
+VBS_WORD *VBS_cur;
+int VBS_cur_lo, VBS_cur_hi;
+// Class labels of VBS_nperm permutations, interleaved by word: VBS_perm[w*VBS_nperm + j] holds the labels
+// of the transactions of word w in permutation j, so that all permutations of a word are contiguous
+VBS_WORD *VBS_perm;
+int VBS_nperm;
+// Top-level items explored by VBS_closed_iter, those in [VBS_top_begin,VBS_top_end). All of them, unless the
+// database is mined by parts (out_of_core.c)
+int VBS_top_begin, VBS_top_end;
+
+/* FUNCTION DECLARATIONS */
+// Defined in the file processing the solutions (one per test)
+void vbs_process_solution(int x, int a);
+
+/* INITIALISATION AND TERMINATION FUNCTIONS */
+
+/* Allocate the arrays indexed by the items. Must be called after LCM_Eend is known */
+void VBS_items_init(){
+	VBS_frq = (int *)calloc(LCM_Eend,sizeof(int));
+	if(!VBS_frq){
+		fprintf(stderr,"Error in function VBS_items_init: couldn't allocate memory for array VBS_frq\n");
+		exit(1);
+	}
+	VBS_in = (char *)calloc(LCM_Eend,sizeof(char));
+	if(!VBS_in){
+		fprintf(stderr,"Error in function VBS_items_init: couldn't allocate memory for array VBS_in\n");
+		exit(1);
+	}
+	VBS_items = (int *)malloc(LCM_Eend*sizeof(int));
+	if(!VBS_items){
+		fprintf(stderr,"Error in function VBS_items_init: couldn't allocate memory for array VBS_items\n");
+		exit(1);
+	}
+	VBS_itemst = 0;
+	VBS_perm = ((VBS_WORD *)0);
+	VBS_nperm = 0;
+	VBS_lab = ((VBS_WORD *)0);
+}
+
+/* Allocate empty tidsets of ntrans transactions for all items, and the stack of the search */
+void VBS_tidsets_init(int ntrans){
+	VBS_words = CEIL(ntrans,VBS_WORD_BITS);
+	VBS_tid = (VBS_WORD *)calloc(((size_t)LCM_Eend)*VBS_words,sizeof(VBS_WORD));
+	if(!VBS_tid){
+		fprintf(stderr,"Error in function VBS_tidsets_init: couldn't allocate memory for array VBS_tid\n");
+		exit(1);
+	}
+	// The depth of the search tree is at most the number of items, plus the root
+	VBS_stack = (VBS_WORD *)malloc(((size_t)LCM_Eend+1)*VBS_words*sizeof(VBS_WORD));
+	if(!VBS_stack){
+		fprintf(stderr,"Error in function VBS_tidsets_init: couldn't allocate memory for array VBS_stack\n");
+		exit(1);
+	}
+}
+
+/* Build the tidsets of all items from the (merged) transactions loaded by LCM_init.
+ * labels is the vector of class labels of the non-empty transactions, or NULL if the cell counts are not needed
+ * */
+void VBS_init(char *labels){
+	int t, e, i, *ptr, *end_ptr;
+	QUEUE *Q = LCM_Trsact.h;
+	QUEUE_INT *x;
+
+	VBS_items_init();
+	VBS_tidsets_init(root_trans_list.siz1);
+
+	// Items of merged transaction t are the bits of Q[t].s (items below LCM_BM_MAXITEM) and the list Q[t].q,
+	// and its original transactions are those kept in root_trans_list
+	for(t=0;t<LCM_Trsact.num;t++){
+		end_ptr = (t == (root_trans_list.siz2-1)) ? root_trans_list.list + root_trans_list.siz1 : root_trans_list.ptr[t+1];
+		for(ptr = root_trans_list.ptr[t];ptr < end_ptr;ptr++){
+			for(e=0;e<LCM_BM_MAXITEM;e++){
+				if(Q[t].s & BITMASK_1[e]) VBS_tid[e*VBS_words + *ptr/VBS_WORD_BITS] |= 1ULL << (*ptr%VBS_WORD_BITS);
+			}
+			for(x=Q[t].q;*x<LCM_Eend;x++) VBS_tid[(*x)*VBS_words + *ptr/VBS_WORD_BITS] |= 1ULL << (*ptr%VBS_WORD_BITS);
+		}
+	}
+	for(e=0;e<LCM_Eend;e++){
+		for(i=0;i<VBS_words;i++) VBS_frq[e] += VBS_POPCOUNT(VBS_tid[e*VBS_words+i]);
+	}
+
+	if(labels){
+		VBS_lab = (VBS_WORD *)calloc(VBS_words,sizeof(VBS_WORD));
+		if(!VBS_lab){
+			fprintf(stderr,"Error in function VBS_init: couldn't allocate memory for array VBS_lab\n");
+			exit(1);
+		}
+		for(i=0;i<root_trans_list.siz1;i++){
+			if(labels[i]) VBS_lab[i/VBS_WORD_BITS] |= 1ULL << (i%VBS_WORD_BITS);
+		}
+	}
+}
+
+void VBS_end(){
+	free(VBS_tid);
+	free(VBS_stack);
+	free(VBS_frq);
+	free(VBS_in);
+	free(VBS_items);
+	free(VBS_lab);
+	free(VBS_perm);
+}
+
+/* Allocate the bitsets of J permuted label vectors, to be filled with VBS_perm_set. Must be called after VBS_init */
+void VBS_perm_init(int J){
+	VBS_nperm = J;
+	VBS_perm = (VBS_WORD *)calloc(((size_t)VBS_words)*J,sizeof(VBS_WORD));
+	if(!VBS_perm){
+		fprintf(stderr,"Error in function VBS_perm_init: couldn't allocate memory for array VBS_perm\n");
+		exit(1);
+	}
+}
+
+/* Store the class labels of the non-empty transactions in permutation j */
+void VBS_perm_set(int j, char *labels){
+	int i;
+	for(i=0;i<root_trans_list.siz1;i++){
+		if(labels[i]) VBS_perm[((size_t)(i/VBS_WORD_BITS))*VBS_nperm + j] |= 1ULL << (i%VBS_WORD_BITS);
+	}
+}
+
+/* Cell counts of the solution being processed in all permutations, a[j] for permutation j. All counts are
+ * accumulated in a single pass over the non-zero words of the tidset
+ * */
+void VBS_perm_counts(int *a){
+	VBS_WORD *P, t;
+	int w, j;
+	for(j=0;j<VBS_nperm;j++) a[j] = 0;
+	for(w=VBS_cur_lo;w<=VBS_cur_hi;w++){
+		if(!(t = VBS_cur[w])) continue;
+		P = VBS_perm + ((size_t)w)*VBS_nperm;
+		for(j=0;j<VBS_nperm;j++) a[j] += VBS_POPCOUNT(t & P[j]);
+	}
+}
+
+/* MINING FUNCTIONS */
+
+// Add item e to the current itemset, both here and in LCM (so that the itemset can be output as usual)
+void VBS_additem(int e){
+	LCM_additem(e);
+	VBS_in[e] = 1;
+	VBS_items[VBS_itemst++] = e;
+}
+
+// Remove the last item added to the current itemset
+void VBS_delitem(){
+	LCM_delitem();
+	VBS_in[VBS_items[--VBS_itemst]] = 0;
+}
+
+// Check if the tidset T, whose non-zero words are in [lo,hi], is contained in the tidset of item e
+int VBS_subset(VBS_WORD *T, int e, int lo, int hi){
+	VBS_WORD *tid = VBS_tid + e*VBS_words;
+	int w;
+	for(w=lo;w<=hi;w++) if(T[w] & ~tid[w]) return 0;
+	return 1;
+}
+
+/* Enumerate all closed itemsets which are prefix-preserving closure extensions of the current itemset
+ * core = item that generated the current itemset
+ * depth = position of the tidset of the current itemset in VBS_stack
+ * lo, hi = first and last non-zero words of that tidset
+ * */
+void VBS_closed_iter(int core, int depth, int lo, int hi){
+	VBS_WORD *T = VBS_stack + depth*VBS_words, *TT = T + VBS_words, *tid;
+	int e, j, w, x, a, it, nlo, nhi;
+
+	for(e=core+1; e<LCM_Eend; e++){
+		if(core < 0){
+			if((e < VBS_top_begin) || (e >= VBS_top_end) || !workers_item(e) || !checkpoint_item(e)) continue;
+			progress_item = e;
+		}
+		// The minimum support may have been increased by the last solution processed
+		if(VBS_in[e] || VBS_frq[e] < LCM_th) continue;
+
+		// Tidset of the extension, with its support and cell count
+		tid = VBS_tid + e*VBS_words;
+		x = 0; a = 0; nlo = hi+1; nhi = lo-1;
+		if(VBS_lab){
+			for(w=lo;w<=hi;w++){
+				TT[w] = T[w] & tid[w];
+				if(TT[w]){
+					x += VBS_POPCOUNT(TT[w]);
+					a += VBS_POPCOUNT(TT[w] & VBS_lab[w]);
+					if(nlo > hi) nlo = w;
+					nhi = w;
+				}
+			}
+		}else{
+			for(w=lo;w<=hi;w++){
+				TT[w] = T[w] & tid[w];
+				if(TT[w]){
+					x += VBS_POPCOUNT(TT[w]);
+					if(nlo > hi) nlo = w;
+					nhi = w;
+				}
+			}
+		}
+		if(x < LCM_th) continue;
+
+		// Prefix-preserving check: the closure must not contain new items smaller than e
+		for(j=0; j<e; j++){
+			if(!VBS_in[j] && VBS_frq[j] >= x && VBS_subset(TT,j,nlo,nhi)) break;
+		}
+		if(j < e) continue;
+
+		// Add e and the rest of the closure to the current itemset
+		it = VBS_itemst;
+		VBS_additem(e);
+		for(j=e+1; j<LCM_Eend; j++){
+			if(!VBS_in[j] && VBS_frq[j] >= x && VBS_subset(TT,j,nlo,nhi)) VBS_additem(j);
+		}
+
+		LCM_iters++;
+		// Itemset constraints (constraints.c): the subtree adds the items above e
+		if(cons_prune(cons_req_max > e)){
+			while(VBS_itemst > it) VBS_delitem();
+			continue;
+		}
+		LCM_frq = x;
+		LCM_solution();
+		VBS_cur = TT; VBS_cur_lo = nlo; VBS_cur_hi = nhi;
+		if(cons_admissible()){
+			INSTR_BEGIN(INSTR_TEST);
+			vbs_process_solution(x,a);
+			INSTR_END(INSTR_TEST);
+		}
+
+		if(x >= LCM_th) VBS_closed_iter(e,depth+1,nlo,nhi);
+		while(VBS_itemst > it) VBS_delitem();
+	}
+}
+
+/* main of the vertical bitset engine, replaces LCMclosed() */
+void VBS_closed(){
+	VBS_WORD *T = VBS_stack;
+	int e, w;
+
+	progress_begin();
+	checkpoint_begin();
+	// The root is the closure of the empty itemset, that is, the set of all transactions
+	for(w=0;w<VBS_words;w++) T[w] = ~0ULL;
+	if(root_trans_list.siz1 % VBS_WORD_BITS) T[VBS_words-1] = (1ULL << (root_trans_list.siz1 % VBS_WORD_BITS)) - 1;
+	// Items contained in all transactions belong to every closed itemset. As in LCMclosed(), the root itself
+	// is not processed as a solution
+	for(e=0;e<LCM_Eend;e++){
+		if(VBS_frq[e] == root_trans_list.siz1) VBS_additem(e);
+	}
+	// Partitioned mining (workers.c): the subtree of an item is explored on its tidset, with the items after it
+	if(workers_n > 1){
+		for(e=0;e<LCM_Eend;e++) workers_cost[e] = ((double)VBS_frq[e])*(LCM_Eend-1-e);
+		workers_begin();
+	}
+
+	VBS_top_begin = 0; VBS_top_end = LCM_Eend;
+	VBS_closed_iter(-1,0,0,VBS_words-1);
+
+	while(VBS_itemst > 0) VBS_delitem();
+	LCM_iters++;
+	progress_end();
+}
+
+#endif
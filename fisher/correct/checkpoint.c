@@ -0,0 +1,201 @@
+#ifndef _checkpoint_c_
+#define _checkpoint_c_
+
+/* CHECKPOINTS
+ * The subtrees of the top-level items of the search are explored one after the other, and only the counters of the
+ * program and the output files carry information from one to the next. With the optional argument
+ * -checkpoint seconds, the state of the run is saved to <output_basefilename>_checkpoint.bin at the boundary between
+ * two top-level items, at most every given number of seconds. The file holds
+ * 	- a header with the command line, the size of the dataset, the engine and the first top-level item not
+ * 	  completed, with LCM_th and LCM_iters,
+ * 	- the state of the program, saved by checkpoint_state (defined by each program next to its counters), including
+ * 	  the lengths of its output files at that point.
+ * It is written under a temporary name and then renamed, so the previous checkpoint stays valid until the new one
+ * is complete.
+ * A run killed for any reason is resumed by running the same command line with the optional argument -resume added.
+ * The dataset is loaded and the program initialised again as usual, then the state is restored, the output files are
+ * truncated to their length at the checkpoint and the top-level items completed before it are skipped. The output
+ * files are then identical to those of an uninterrupted run.
+ * The bitmap phase of LCM counts as the single top-level item 0, and the items of the array phase follow.
+ * */
+
+/* CODE DEPENDENCIES */
+#include<unistd.h>
+#include<sys/types.h>
+
+/* CONSTANT DEFINES */
+#define CHECKPOINT_MAGIC "SIGCKP01"
+// Mode in which the output files which are part of the checkpoint must be opened
+#define CHECKPOINT_FOPEN_MODE (checkpoint_resume ? "r+" : "w")
+
+/* TYPES */
+typedef struct {
+	char magic[8];
+	int trsact_num, Eend, bm_maxitem, vertical;
+	int next_item, LCM_th, LCM_iters;
+	int cmdline_len; // Length of the command line which follows the header
+} CHECKPOINT_HEADER;
+
+/* FUNCTION DECLARATIONS */
+// Defined by each program
+void checkpoint_state();
+// Defined in lcm_bm.c and vertical_bitset.c
+extern int LCM_BM_MAXITEM, use_vertical_engine;
+
+/* GLOBAL VARIABLES */
+// Interval between checkpoints in seconds, 0 if they are disabled, and 1 if the run resumes from a checkpoint
+double checkpoint_interval = 0;
+int checkpoint_resume = 0;
+// First top-level item not completed, and wall-clock time of the last checkpoint
+int checkpoint_next_item = 0;
+double checkpoint_last;
+// Checkpoint being written (checkpoint_saving = 1) or read
+FILE *checkpoint_file;
+int checkpoint_saving;
+char *checkpoint_filename, *checkpoint_tmp_filename, *checkpoint_cmdline;
+
+/* INITIALISATION FUNCTIONS */
+
+/* Parse an optional argument -checkpoint value of main. Returns 1 if the argument was consumed */
+int checkpoint_option(char *arg, char *value){
+	if(strcmp(arg,"-checkpoint")) return 0;
+	checkpoint_interval = atof(value);
+	if(checkpoint_interval <= 0){
+		fprintf(stderr,"Error in function checkpoint_option: the interval between checkpoints must be positive\n");
+		exit(1);
+	}
+	return 1;
+}
+
+/* Keep the names of the files and the command line without -resume. Must be called after metrics_init */
+void checkpoint_init(){
+	int i, len;
+
+	checkpoint_filename = (char *)malloc((strlen(metrics_basefilename)+512)*sizeof(char));
+	checkpoint_tmp_filename = (char *)malloc((strlen(metrics_basefilename)+512)*sizeof(char));
+	if(!checkpoint_filename || !checkpoint_tmp_filename){
+		fprintf(stderr,"Error in function checkpoint_init: couldn't allocate memory for array checkpoint_filename\n");
+		exit(1);
+	}
+	strcpy(checkpoint_filename,metrics_basefilename); strcat(checkpoint_filename,"_checkpoint.bin");
+	strcpy(checkpoint_tmp_filename,metrics_basefilename); strcat(checkpoint_tmp_filename,"_checkpoint.bin.tmp");
+
+	for(i=1, len=1; i<metrics_argc; i++) len += strlen(metrics_argv[i])+1;
+	checkpoint_cmdline = (char *)malloc(len*sizeof(char));
+	if(!checkpoint_cmdline){
+		fprintf(stderr,"Error in function checkpoint_init: couldn't allocate memory for array checkpoint_cmdline\n");
+		exit(1);
+	}
+	checkpoint_cmdline[0] = '\0';
+	for(i=1; i<metrics_argc; i++){
+		if(!strcmp(metrics_argv[i],"-resume")) continue;
+		strcat(checkpoint_cmdline,metrics_argv[i]); strcat(checkpoint_cmdline," ");
+	}
+}
+
+/* READ AND WRITE FUNCTIONS, used by checkpoint_state */
+
+/* Write size bytes from p to the checkpoint, or read them into p when resuming */
+void checkpoint_data(void *p, size_t size){
+	if(checkpoint_saving){
+		if(fwrite(p,1,size,checkpoint_file) != size){
+			fprintf(stderr,"Error in function checkpoint_data: couldn't write to the checkpoint file\n");
+			exit(1);
+		}
+	}else if(fread(p,1,size,checkpoint_file) != size){
+		fprintf(stderr,"Error in function checkpoint_data: truncated checkpoint file\n");
+		exit(1);
+	}
+}
+
+/* Save the length of the output file f, or truncate it to the saved length when resuming */
+void checkpoint_output_file(FILE *f){
+	off_t len;
+	fflush(f);
+	if(checkpoint_saving) len = ftello(f);
+	checkpoint_data(&len,sizeof(off_t));
+	if(!checkpoint_saving && (ftruncate(fileno(f),len) || fseeko(f,len,SEEK_SET))){
+		fprintf(stderr,"Error in function checkpoint_output_file: couldn't truncate an output file\n");
+		exit(1);
+	}
+}
+
+/* CORE FUNCTIONS */
+
+void checkpoint_save(){
+	CHECKPOINT_HEADER header;
+
+	if(!(checkpoint_file = fopen(checkpoint_tmp_filename,"wb"))){
+		fprintf(stderr, "Error in function checkpoint_save when opening file %s\n",checkpoint_tmp_filename);
+		exit(1);
+	}
+	checkpoint_saving = 1;
+	memset(&header,0,sizeof(CHECKPOINT_HEADER));
+	memcpy(header.magic,CHECKPOINT_MAGIC,8);
+	header.trsact_num = LCM_trsact_num; header.Eend = LCM_Eend; header.bm_maxitem = LCM_BM_MAXITEM;
+	header.vertical = use_vertical_engine;
+	header.next_item = checkpoint_next_item; header.LCM_th = LCM_th; header.LCM_iters = LCM_iters;
+	header.cmdline_len = strlen(checkpoint_cmdline);
+	checkpoint_data(&header,sizeof(CHECKPOINT_HEADER));
+	checkpoint_data(checkpoint_cmdline,header.cmdline_len);
+	checkpoint_state();
+	if(fclose(checkpoint_file) || rename(checkpoint_tmp_filename,checkpoint_filename)){
+		fprintf(stderr, "Error in function checkpoint_save when writing file %s\n",checkpoint_filename);
+		exit(1);
+	}
+	checkpoint_last = measureWallTime();
+}
+
+/* Restore the state of the run from the checkpoint, checking that it was written by the same command line on the
+ * same dataset
+ * */
+void checkpoint_load(){
+	CHECKPOINT_HEADER header;
+	char *cmdline;
+
+	if(!(checkpoint_file = fopen(checkpoint_filename,"rb"))){
+		fprintf(stderr, "Error in function checkpoint_load when opening file %s\n",checkpoint_filename);
+		exit(1);
+	}
+	checkpoint_saving = 0;
+	checkpoint_data(&header,sizeof(CHECKPOINT_HEADER));
+	if(memcmp(header.magic,CHECKPOINT_MAGIC,8)){
+		fprintf(stderr,"Error in function checkpoint_load: %s is not a checkpoint file\n",checkpoint_filename);
+		exit(1);
+	}
+	cmdline = (char *)malloc((header.cmdline_len+1)*sizeof(char));
+	if(!cmdline){
+		fprintf(stderr,"Error in function checkpoint_load: couldn't allocate memory for array cmdline\n");
+		exit(1);
+	}
+	checkpoint_data(cmdline,header.cmdline_len);
+	cmdline[header.cmdline_len] = '\0';
+	if(strcmp(cmdline,checkpoint_cmdline) || (header.trsact_num != LCM_trsact_num) || (header.Eend != LCM_Eend) ||
+			(header.bm_maxitem != LCM_BM_MAXITEM) || (header.vertical != use_vertical_engine)){
+		fprintf(stderr,"Error in function checkpoint_load: the checkpoint was written by a different command line or dataset\n");
+		exit(1);
+	}
+	free(cmdline);
+	checkpoint_next_item = header.next_item; LCM_th = header.LCM_th; LCM_iters = header.LCM_iters;
+	checkpoint_state();
+	fclose(checkpoint_file);
+}
+
+/* Called by LCMclosed and VBS_closed when the mining starts */
+void checkpoint_begin(){
+	checkpoint_last = measureWallTime();
+	if(checkpoint_resume) checkpoint_load();
+}
+
+/* Called before the subtree of the top-level item i is explored. Returns 0 if it was completed before the
+ * checkpoint the run resumed from. Otherwise, all items before i are complete, and a checkpoint is written if one
+ * is due
+ * */
+int checkpoint_item(int i){
+	if(i < checkpoint_next_item) return 0;
+	checkpoint_next_item = i;
+	if(checkpoint_interval && (measureWallTime()-checkpoint_last >= checkpoint_interval)) checkpoint_save();
+	return 1;
+}
+
+#endif
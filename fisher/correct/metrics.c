@@ -0,0 +1,221 @@
+#ifndef _metrics_c_
+#define _metrics_c_
+
+/* MACHINE-READABLE METRICS
+ * At the end of the run, a single JSON document is written to <output_basefilename>_metrics.json:
+ * 	{"program": ..., "final": true, "elapsed": {"wall_s": ..., "cpu_s": ...},
+ * 	 "config": {"argv": [...], ...}, "counters": {...},
+ * 	 "phases": {"<phase>": {"wall_s": ..., "cpu_s": ...}, ...}, "peak_memory_kb": ...}
+ * The configuration and the counters are written by metrics_config and metrics_counters, defined by each program next
+ * to its counters, and the phases and memory consumption by metrics_timing (time_keeping.c).
+ * With the optional argument -metrics_interval seconds, the same document is also written every given number of
+ * seconds during the run, with "final": false, as one line of <output_basefilename>_metrics_stream.jsonl. The timer
+ * (SIGALRM) only raises a flag, and the snapshot is written by LCM_solution the next time a solution is found, when the
+ * counters are consistent. Phases which have not finished yet have a time of 0 in the snapshots.
+ * */
+
+/* CODE DEPENDENCIES */
+#include<signal.h>
+#include<math.h>
+
+/* FUNCTION DECLARATIONS */
+// Defined in time_keeping.c
+double measureTime();
+double measureWallTime();
+void metrics_timing();
+extern double t_init, t_end, wt_init, wt_end;
+// Defined by each program
+void metrics_config();
+void metrics_counters();
+
+/* GLOBAL VARIABLES */
+// Interval between snapshots in seconds, 0 if they are disabled
+double metrics_interval = 0;
+// Set by the timer when a snapshot is due
+volatile sig_atomic_t metrics_due = 0;
+// Document being written, and 1 if the next value is the first one of its object
+FILE *metrics_file, *metrics_stream_file;
+int metrics_first;
+// Name of the program, output base filename and original command line
+const char *metrics_program;
+char *metrics_basefilename;
+int metrics_argc;
+char **metrics_argv;
+
+/* JSON WRITING FUNCTIONS */
+
+void metrics_key(const char *name){
+	fprintf(metrics_file,metrics_first ? "\"%s\":" : ",\"%s\":",name);
+	metrics_first = 0;
+}
+
+void metrics_string_value(const char *value){
+	fputc('"',metrics_file);
+	for(; *value; value++){
+		if((*value == '"') || (*value == '\\')) fprintf(metrics_file,"\\%c",*value);
+		else if((unsigned char)*value < 0x20) fprintf(metrics_file,"\\u%04x",*value);
+		else fputc(*value,metrics_file);
+	}
+	fputc('"',metrics_file);
+}
+
+void metrics_int(const char *name, long long value){
+	metrics_key(name);
+	fprintf(metrics_file,"%lld",value);
+}
+
+// Non-finite values are not valid JSON numbers, and are written as null
+void metrics_double(const char *name, double value){
+	metrics_key(name);
+	if(isfinite(value)) fprintf(metrics_file,"%.17g",value);
+	else fprintf(metrics_file,"null");
+}
+
+void metrics_string(const char *name, const char *value){
+	metrics_key(name);
+	metrics_string_value(value);
+}
+
+void metrics_object_begin(const char *name){
+	metrics_key(name);
+	fputc('{',metrics_file);
+	metrics_first = 1;
+}
+
+void metrics_object_end(){
+	fputc('}',metrics_file);
+	metrics_first = 0;
+}
+
+// Wall-clock and CPU time of a phase, in seconds
+void metrics_phase(const char *name, double wall, double cpu){
+	metrics_object_begin(name);
+	metrics_double("wall_s",wall);
+	metrics_double("cpu_s",cpu);
+	metrics_object_end();
+}
+
+/* Write the whole document to f, on a single line. final = 1 at the end of the run */
+void metrics_write(FILE *f, int final){
+	int i;
+	metrics_file = f; metrics_first = 1;
+	fputc('{',metrics_file);
+	metrics_string("program",metrics_program);
+	metrics_key("final");
+	fprintf(metrics_file,final ? "true" : "false");
+	if(final) metrics_phase("elapsed",wt_end-wt_init,t_end-t_init);
+	else metrics_phase("elapsed",measureWallTime()-wt_init,measureTime()-t_init);
+	metrics_object_begin("config");
+	metrics_key("argv");
+	fputc('[',metrics_file);
+	for(i=0; i<metrics_argc; i++){
+		if(i) fputc(',',metrics_file);
+		metrics_string_value(metrics_argv[i]);
+	}
+	fputc(']',metrics_file);
+	metrics_config();
+	metrics_object_end();
+	metrics_object_begin("counters");
+	metrics_counters();
+	metrics_object_end();
+	metrics_timing();
+	fprintf(metrics_file,"}\n");
+}
+
+/* INITIALISATION AND TERMINATION FUNCTIONS */
+
+/* Parse an optional argument -metrics_interval value of main. Returns 1 if the argument was consumed */
+int metrics_option(char *arg, char *value){
+	if(strcmp(arg,"-metrics_interval")) return 0;
+	metrics_interval = atof(value);
+	if(metrics_interval <= 0){
+		fprintf(stderr,"Error in function metrics_option: the interval between snapshots must be positive\n");
+		exit(1);
+	}
+	return 1;
+}
+
+void metrics_alarm(int sig){
+	metrics_due = 1;
+}
+
+/* Keep the command line and, if snapshots were requested, create their file and start the timer. Must be called
+ * before main modifies argv
+ * */
+void metrics_init(const char *program, int argc, char **argv){
+	struct sigaction sa;
+	struct itimerval timer;
+	char *tmp_filename;
+	int i;
+
+	metrics_program = program;
+	metrics_argc = argc;
+	metrics_argv = (char **)malloc(argc*sizeof(char *));
+	if(!metrics_argv){
+		fprintf(stderr,"Error in function metrics_init: couldn't allocate memory for array metrics_argv\n");
+		exit(1);
+	}
+	for(i=0; i<argc; i++) metrics_argv[i] = argv[i];
+	metrics_basefilename = argv[1];
+	if(metrics_interval <= 0) return;
+
+	tmp_filename = (char *)malloc((strlen(metrics_basefilename)+512)*sizeof(char));
+	if(!tmp_filename){
+		fprintf(stderr,"Error in function metrics_init: couldn't allocate memory for array tmp_filename\n");
+		exit(1);
+	}
+	strcpy(tmp_filename,metrics_basefilename); strcat(tmp_filename,"_metrics_stream.jsonl");
+	if(!(metrics_stream_file = fopen(tmp_filename,"w"))){
+		fprintf(stderr, "Error in function metrics_init when opening file %s\n",tmp_filename);
+		exit(1);
+	}
+	free(tmp_filename);
+
+	// Interrupted system calls (such as the writes of the output files) are restarted
+	memset(&sa,0,sizeof(struct sigaction));
+	sa.sa_handler = metrics_alarm;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGALRM,&sa,NULL);
+	timer.it_value.tv_sec = (time_t)metrics_interval;
+	timer.it_value.tv_usec = (suseconds_t)((metrics_interval - (time_t)metrics_interval)*1e6);
+	if(!timer.it_value.tv_sec && !timer.it_value.tv_usec) timer.it_value.tv_usec = 1;
+	timer.it_interval = timer.it_value;
+	setitimer(ITIMER_REAL,&timer,NULL);
+}
+
+/* Write a snapshot, when metrics_due has been set by the timer */
+void metrics_stream(){
+	metrics_due = 0;
+	metrics_write(metrics_stream_file,0);
+	fflush(metrics_stream_file);
+}
+
+/* Stop the timer and write the final document. Must be called after profileCode */
+void metrics_end(){
+	struct itimerval timer;
+	char *tmp_filename;
+	FILE *f;
+
+	if(metrics_interval > 0){
+		memset(&timer,0,sizeof(struct itimerval));
+		setitimer(ITIMER_REAL,&timer,NULL);
+		fclose(metrics_stream_file);
+	}
+	tmp_filename = (char *)malloc((strlen(metrics_basefilename)+512)*sizeof(char));
+	if(!tmp_filename){
+		fprintf(stderr,"Error in function metrics_end: couldn't allocate memory for array tmp_filename\n");
+		exit(1);
+	}
+	strcpy(tmp_filename,metrics_basefilename); strcat(tmp_filename,"_metrics.json");
+	if(!(f = fopen(tmp_filename,"w"))){
+		fprintf(stderr, "Error in function metrics_end when opening file %s\n",tmp_filename);
+		exit(1);
+	}
+	free(tmp_filename);
+	metrics_write(f,1);
+	fclose(f);
+	free(metrics_argv);
+}
+
+#endif
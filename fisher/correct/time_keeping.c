@@ -9,6 +9,12 @@
 
 /* CODE DEPENDENCIES */
 #include"var_declare.h"
+#include"metrics.c"
+#include"instrument.c"
+#include"progress.c"
+#include"checkpoint.c"
+#include"workers.c"
+#include"constraints.c"
 
 /* GLOBAL VARIABLES (TIME SPENT) */
 FILE* timing_file;
@@ -18,6 +24,13 @@ double time_threshold_correction = 0;
 double time_termination = 0;
 double t_init,t_end;
 double tic,toc;
+// Wall-clock time of the same phases
+double wall_LCM_init = 0;
+double wall_initialisation_lamp = 0;
+double wall_threshold_correction = 0;
+double wall_termination = 0;
+double wt_init,wt_end;
+double wtic;
 
 
 // Measure running time
@@ -30,6 +43,13 @@ double measureTime(){
   return tv.tv_sec + ts.tv_sec + ((double)tv.tv_usec + (double)ts.tv_usec) * 1e-6;
 }
 
+// Measure elapsed wall-clock time
+double measureWallTime(){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
 // Measure peak memory usage
 size_t measurePeakMemory(){
   struct rusage t;
@@ -52,8 +72,27 @@ void profileCode(){
 	peak_memory = measurePeakMemory();
 	fprintf(timing_file,"Peak memory consumption: %lld (KB in Linux, B in Mac OS X).\n",peak_memory);
 
+	#ifdef INSTRUMENT
+	instr_report(timing_file);
+	#endif
+
 	// Close timing file
 	fclose(timing_file);
 }
 
+// Write the wall-clock and CPU time of each phase and the peak memory consumption to the metrics document (metrics.c)
+void metrics_timing(){
+	metrics_object_begin("phases");
+	metrics_phase("LCM_init",wall_LCM_init,time_LCM_init);
+	metrics_phase("lamp_init",wall_initialisation_lamp,time_initialisation_lamp);
+	metrics_phase("threshold_correction",wall_threshold_correction,time_threshold_correction);
+	metrics_phase("termination",wall_termination,time_termination);
+	metrics_object_end();
+	metrics_int("peak_memory_kb",measurePeakMemory());
+	progress_metrics();
+	#ifdef INSTRUMENT
+	instr_metrics();
+	#endif
+}
+
 #endif
@@ -8,11 +8,13 @@ typedef struct{
 	int siz2;//Number of merged transactions in the list
 	int *list;//List of all original transactions
 	int **ptr;//List of pointers such that ptr[i] points to the point of list such that the transactions belonging to the i-th merged transaction begins
+	int *pos;//pos[i] is the number of original transactions in the i-th merged transaction which belong to the positive class
 }TRANS_LIST;
 
 typedef struct{
 	int siz;//Current size
 	int max_siz;//Maximum allocated memory
+	int pos;//Number of original transactions in the list which belong to the positive class
 	int *list;//Pointer to contents
 }BM_TRANS_LIST;
 
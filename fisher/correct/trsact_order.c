@@ -0,0 +1,144 @@
+#ifndef _trsact_order_c_
+#define _trsact_order_c_
+
+/* TRANSACTION REORDERING
+ * LCM keeps the (merged) transactions in the order of the file, so the occurrence lists built by LCM_occ_deliver,
+ * and the scans of LCM_freq_calc and LCM_shrink which follow them, jump around the database. With the optional
+ * argument -trsact_order lex|gray|size, the transactions are reordered once, when LCM_init has merged the identical
+ * ones:
+ * 	lex  : lexicographic order of their items, numbered by decreasing frequency by LCM_BM_load, so that the
+ * 	       transactions sharing the most frequent items are consecutive,
+ * 	gray : reflected Gray-code order of the same item vectors, in which consecutive transactions differ in as
+ * 	       few items as possible,
+ * 	size : decreasing number of items, as TRSACT_sort_by_size of the original LCM,
+ * ties being kept in the order of the file. The items of the transactions are packed in the new order too, so the
+ * transactions of an occurrence list are close in memory.
+ * The original transactions merged into each transaction (root_trans_list, transaction_keeping.c) move with it.
+ * They are numbered after the non-empty transactions of the file (non_empty_trans_idx), which is not changed, so
+ * the class labels stay consistent. Only the memory accesses change: the solutions found, and their order, are
+ * those of the file order. The llc_misses of the bm, ary and shrink timers of a build with -DINSTRUMENT
+ * (instrument.c) give the cache misses before and after, by running with and without the option.
+ * The vertical engine indexes the transactions by their position in the file and is not affected.
+ * */
+
+/* CONSTANT DEFINES */
+#define TRSACT_ORDER_FILE 0
+#define TRSACT_ORDER_LEX 1
+#define TRSACT_ORDER_GRAY 2
+#define TRSACT_ORDER_SIZE 3
+#define TRSACT_ORDER_N 4
+
+/* GLOBAL VARIABLES */
+// Order of the transactions, and the names of the orders in the command line
+int trsact_order = TRSACT_ORDER_FILE;
+const char *trsact_order_names[TRSACT_ORDER_N] = {"file","lex","gray","size"};
+// Transactions being sorted, for trsact_order_cmp
+QUEUE *trsact_order_Q;
+
+/* INITIALISATION FUNCTIONS */
+
+/* Parse an optional argument -trsact_order value of main. Returns 1 if the argument was consumed */
+int trsact_order_option(char *arg, char *value){
+	int i;
+	if(strcmp(arg,"-trsact_order")) return 0;
+	for(i=0; i<TRSACT_ORDER_N; i++) if(!strcmp(value,trsact_order_names[i])) break;
+	if(i == TRSACT_ORDER_N){
+		fprintf(stderr,"Error in function trsact_order_option: unknown order of the transactions %s\n",value);
+		exit(1);
+	}
+	trsact_order = i;
+	return 1;
+}
+
+/* CORE FUNCTIONS */
+
+/* Number of items of a transaction: those of the bitmap, and those of the list */
+int trsact_order_size(QUEUE *A){
+	return __builtin_popcount((unsigned int)A->s) + A->t;
+}
+
+/* Orders two transactions, given by their indices. In the lexicographic order, at the first item contained in only
+ * one of them, the one containing it comes first. The Gray-code order is the same when they share an even number
+ * of items before it, and the reverse otherwise
+ * */
+int trsact_order_cmp(const void *elem1, const void *elem2){
+	int t1 = *(const int *)elem1, t2 = *(const int *)elem2, odd = 0, first;
+	QUEUE *A = trsact_order_Q+t1, *B = trsact_order_Q+t2;
+	unsigned int d;
+	QUEUE_INT *x, *y;
+
+	if(trsact_order == TRSACT_ORDER_SIZE){
+		first = trsact_order_size(B) - trsact_order_size(A);
+		return first ? first : t1-t2;
+	}
+	// Items of the bitmap first, which are the most frequent ones
+	if((d = ((unsigned int)A->s) ^ ((unsigned int)B->s))){
+		d &= -d;
+		if(trsact_order == TRSACT_ORDER_GRAY) odd = __builtin_popcount(((unsigned int)A->s) & (d-1)) & 1;
+		first = (((unsigned int)A->s) & d) ? -1 : 1;
+		return odd ? -first : first;
+	}
+	if(trsact_order == TRSACT_ORDER_GRAY) odd = __builtin_popcount((unsigned int)A->s) & 1;
+	// Then the lists, both ended by LCM_Eend
+	for(x=A->q, y=B->q; (*x == *y) && (*x < LCM_Eend); x++, y++) if(trsact_order == TRSACT_ORDER_GRAY) odd ^= 1;
+	if(*x == *y) return t1-t2;
+	first = (*x < *y) ? -1 : 1;
+	return odd ? -first : first;
+}
+
+/* Reorder the transactions of T and the lists of original transactions L merged into them, and pack the items of
+ * the transactions in the new order at the beginning of buf, the buffer filled by LCM_BM_load. Called by LCM_init
+ * once the identical transactions have been merged
+ * */
+void TRSACT_reorder(ARY *T, TRANS_LIST *L, QUEUE_INT *buf){
+	int *order, i, t, len, *l;
+	long long n_items;
+	QUEUE *Q = T->h, *QQ;
+	QUEUE_INT *items, *x;
+	TRANS_LIST aux_trans_list;
+
+	if(trsact_order == TRSACT_ORDER_FILE) return;
+	order = (int *)malloc(T->num*sizeof(int));
+	QQ = (QUEUE *)malloc(T->num*sizeof(QUEUE));
+	if(!order || !QQ){
+		fprintf(stderr,"Error in function TRSACT_reorder: couldn't allocate memory for array order\n");
+		exit(1);
+	}
+	for(t=0; t<T->num; t++) order[t] = t;
+	trsact_order_Q = Q;
+	qsort(order,T->num,sizeof(int),trsact_order_cmp);
+
+	// Items of the lists with their loop stoppers, packed in the new order. They take no more room than the
+	// transactions loaded, some of which have been merged
+	for(t=0, n_items=0; t<T->num; t++) n_items += Q[t].t+1;
+	items = (QUEUE_INT *)malloc(n_items*sizeof(QUEUE_INT));
+	if(!items){
+		fprintf(stderr,"Error in function TRSACT_reorder: couldn't allocate memory for array items\n");
+		exit(1);
+	}
+	for(i=0, x=items; i<T->num; i++){
+		QQ[i] = Q[order[i]];
+		memcpy(x,QQ[i].q,(QQ[i].t+1)*sizeof(QUEUE_INT));
+		QQ[i].q = buf + (x-items);
+		x += QQ[i].t+1;
+	}
+	memcpy(buf,items,n_items*sizeof(QUEUE_INT));
+	memcpy(Q,QQ,T->num*sizeof(QUEUE));
+
+	// Original transactions merged into each transaction, in the new order
+	TRANS_LIST_INIT(&aux_trans_list, L->siz1, L->siz2);
+	for(i=0, l=aux_trans_list.list; i<L->siz2; i++){
+		t = order[i];
+		len = ((t == (L->siz2-1)) ? L->list + L->siz1 : L->ptr[t+1]) - L->ptr[t];
+		aux_trans_list.ptr[i] = l;
+		aux_trans_list.pos[i] = L->pos[t];
+		memcpy(l,L->ptr[t],len*sizeof(int));
+		l += len;
+	}
+	TRANS_LIST_END(L);
+	*L = aux_trans_list;
+
+	free(order); free(QQ); free(items);
+}
+
+#endif
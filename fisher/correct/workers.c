@@ -0,0 +1,168 @@
+#ifndef _workers_c_
+#define _workers_c_
+
+/* PARTITIONED MINING
+ * With the optional argument -workers k, the search is spread over k worker processes, forked by the engine once the
+ * dataset has been loaded and the frequencies of the items are known. The top-level items of the search (as in
+ * checkpoint.c, the bitmap phase of LCM counts as the single item 0) are partitioned at that point: the engine
+ * estimates the cost of the subtree of each item in workers_cost, and the items are given in decreasing order of
+ * cost to the worker with the smallest total cost so far. Each worker explores the subtrees of its own items only,
+ * and the parent process, the coordinator, explores none and waits for the workers.
+ * The processes share an array of counters, whose meaning is left to the program. Each process adds its own counts
+ * to workers_delta, which workers_push adds to the shared counters, and reads those of all processes back with
+ * workers_read. The counters are only ever increased, with atomic additions and no lock, so a process may read
+ * values which are slightly out of date but never inconsistent ones.
+ * The shared counters are an anonymous shared mapping inherited by the forked workers, which is a local stand-in for
+ * a run spread over several machines: the processes only ever exchange additions to the counters.
+ * */
+
+/* CODE DEPENDENCIES */
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/types.h>
+#include<sys/wait.h>
+
+/* GLOBAL VARIABLES */
+// Number of processes exploring the search tree, 1 if the mining is not partitioned
+int workers_n = 1;
+// Index of this process among the workers, -1 for the coordinator (and when the mining is not partitioned)
+int workers_id = -1;
+// Shared counters and counts of this process not pushed yet, both workers_len long
+long long *workers_shared, *workers_delta;
+int workers_len;
+// Estimated cost of the subtree of each top-level item, set by the engine, and worker exploring it
+double *workers_cost;
+int *workers_owner;
+// Process IDs of the workers, and LCM_iters when they were forked
+pid_t *workers_pid;
+int workers_iters_begin;
+
+/* INITIALISATION FUNCTIONS */
+
+/* Parse an optional argument -workers value of main. Returns 1 if the argument was consumed */
+int workers_option(char *arg, char *value){
+	if(strcmp(arg,"-workers")) return 0;
+	workers_n = atoi(value);
+	if(workers_n <= 0){
+		fprintf(stderr,"Error in function workers_option: the number of workers must be positive\n");
+		exit(1);
+	}
+	return 1;
+}
+
+/* Allocate len shared counters, and the arrays of the partition. Must be called after LCM_init */
+void workers_init(int len){
+	workers_len = len;
+	workers_shared = (long long *)mmap(NULL,len*sizeof(long long),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+	if(workers_shared == MAP_FAILED){
+		fprintf(stderr,"Error in function workers_init: couldn't map memory for array workers_shared\n");
+		exit(1);
+	}
+	workers_delta = (long long *)calloc(len,sizeof(long long));
+	if(!workers_delta){
+		fprintf(stderr,"Error in function workers_init: couldn't allocate memory for array workers_delta\n");
+		exit(1);
+	}
+	workers_cost = (double *)calloc(LCM_Eend,sizeof(double));
+	if(!workers_cost){
+		fprintf(stderr,"Error in function workers_init: couldn't allocate memory for array workers_cost\n");
+		exit(1);
+	}
+	workers_owner = (int *)malloc(LCM_Eend*sizeof(int));
+	if(!workers_owner){
+		fprintf(stderr,"Error in function workers_init: couldn't allocate memory for array workers_owner\n");
+		exit(1);
+	}
+	workers_pid = (pid_t *)malloc(workers_n*sizeof(pid_t));
+	if(!workers_pid){
+		fprintf(stderr,"Error in function workers_init: couldn't allocate memory for array workers_pid\n");
+		exit(1);
+	}
+}
+
+/* CORE FUNCTIONS */
+
+/* Add the counts of this process to the shared counters, and clear them */
+void workers_push(){
+	int i;
+	for(i=0; i<workers_len; i++){
+		if(!workers_delta[i]) continue;
+		__atomic_fetch_add(workers_shared+i,workers_delta[i],__ATOMIC_RELAXED);
+		workers_delta[i] = 0;
+	}
+}
+
+/* Value of the shared counter i, with the counts of all processes pushed so far */
+long long workers_read(int i){
+	return __atomic_load_n(workers_shared+i,__ATOMIC_RELAXED);
+}
+
+// Orders top-level items by decreasing estimated cost
+int workers_costcomp(const void *elem1, const void *elem2){
+	double c1 = workers_cost[*(const int *)elem1], c2 = workers_cost[*(const int *)elem2];
+	if(c1 > c2) return -1;
+	if(c1 < c2) return 1;
+	return *(const int *)elem1 - *(const int *)elem2;
+}
+
+/* Partition the top-level items according to workers_cost and fork the workers. Called by LCMclosed and VBS_closed
+ * when the mining starts. Returns in every process
+ * */
+void workers_begin(){
+	int *order, i, w, w_min;
+	double *load;
+
+	order = (int *)malloc(LCM_Eend*sizeof(int));
+	load = (double *)calloc(workers_n,sizeof(double));
+	if(!order || !load){
+		fprintf(stderr,"Error in function workers_begin: couldn't allocate memory for array order\n");
+		exit(1);
+	}
+	for(i=0; i<LCM_Eend; i++) order[i] = i;
+	qsort(order,LCM_Eend,sizeof(int),workers_costcomp);
+	for(i=0; i<LCM_Eend; i++){
+		for(w=1, w_min=0; w<workers_n; w++) if(load[w] < load[w_min]) w_min = w;
+		workers_owner[order[i]] = w_min;
+		load[w_min] += workers_cost[order[i]];
+	}
+	free(order); free(load);
+
+	// Counts found before the fork belong to the coordinator. Buffered output must not be written twice
+	workers_push();
+	workers_iters_begin = LCM_iters;
+	fflush(NULL);
+	for(w=0; w<workers_n; w++){
+		workers_pid[w] = fork();
+		if(workers_pid[w] < 0){
+			fprintf(stderr,"Error in function workers_begin: couldn't fork worker %d\n",w);
+			exit(1);
+		}
+		if(!workers_pid[w]){
+			workers_id = w;
+			return;
+		}
+	}
+}
+
+/* Returns 1 if the subtree of the top-level item i must be explored by this process */
+int workers_item(int i){
+	return (workers_n <= 1) || (workers_owner[i] == workers_id);
+}
+
+/* Called by a worker once it has pushed its counts. Leaves the output files to the coordinator */
+void workers_exit(){
+	_exit(0);
+}
+
+/* Called by the coordinator: wait for all workers to finish */
+void workers_wait(){
+	int w, status;
+	for(w=0; w<workers_n; w++){
+		if((waitpid(workers_pid[w],&status,0) < 0) || !WIFEXITED(status) || WEXITSTATUS(status)){
+			fprintf(stderr,"Error in function workers_wait: worker %d failed\n",w);
+			exit(1);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,133 @@
+/* READER OF THE BINARY OUTPUT OF THE SIGNIFICANT PATTERNS
+ * Converts the file <output_basefilename>_sig_patterns.bin written with the optional argument -binary_output (see
+ * binary_output.c) into the text files <output_basefilename>_sig_itemsets.txt and <output_basefilename>_sig_pvalues.txt,
+ * identical to those written without the option. Files of both Fisher's exact test and the unconditional test are
+ * accepted. The latter does not store the probability p0 of the observed table, which is computed again here exactly
+ * as computeP0 (unconditional.c) does.
+ * */
+
+/* CODE DEPENDENCIES */
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<math.h>
+#include"binary_output.h"
+
+/* GLOBAL VARIABLES */
+FILE *bin_file, *itemsets_file, *pvalues_file;
+int N, n;
+double *loggamma;
+int32_t *itemset;
+int itemset_siz;
+
+/* Read len bytes from the binary file. Returns 0 if the file ended before the first byte */
+int read_bytes(void *dst, size_t len){
+	size_t n_read = fread(dst,1,len,bin_file);
+	if(n_read == len) return 1;
+	if(n_read == 0 && feof(bin_file)) return 0;
+	fprintf(stderr,"Error in function read_bytes: truncated binary file\n");
+	exit(1);
+}
+
+/* Open the text file <output_basefilename><suffix> for writing */
+FILE *open_output(char *output_basefilename, char *suffix){
+	char *tmp_filename;
+	FILE *f;
+	tmp_filename = (char *)malloc((strlen(output_basefilename)+512)*sizeof(char));
+	if(!tmp_filename){
+		fprintf(stderr,"Error in function open_output: couldn't allocate memory for array tmp_filename\n");
+		exit(1);
+	}
+	strcpy(tmp_filename,output_basefilename); strcat(tmp_filename,suffix);
+	if(!(f = fopen(tmp_filename,"w"))){
+		fprintf(stderr, "Error in function open_output when opening file %s\n",tmp_filename);
+		exit(1);
+	}
+	free(tmp_filename);
+	return f;
+}
+
+/* Same computation as computeP0 in unconditional.c */
+double computeP0(int x_s, int a_s){
+	double pi = (double)x_s / (double)N;
+	double p0 = (x_s*log(pi)) + ((N-x_s)*log(1-pi));
+	p0 = p0 + (loggamma[N-n] - loggamma[(N-n)-(x_s-a_s)] - loggamma[x_s-a_s]) + (loggamma[n] - loggamma[n-a_s] - loggamma[a_s]);
+	return exp(p0);
+}
+
+int main(int argc, char *argv[]){
+	BINOUT_HEADER header;
+	BINOUT_PVALUE r_pvalue;
+	BINOUT_ITEMSET r_itemset;
+	int32_t tag, pad;
+	int i, len = 0;
+
+	if(argc != 3){
+		printf("BINARY_OUTPUT_READER: input_binary_file output_basefilename\n");
+		exit(1);
+	}
+	if(!(bin_file = fopen(argv[1],"rb"))){
+		fprintf(stderr, "Error in function main when opening file %s\n",argv[1]);
+		exit(1);
+	}
+	if(!read_bytes(&header,sizeof(BINOUT_HEADER)) || memcmp(header.magic,BINOUT_MAGIC,8)){
+		fprintf(stderr,"Error in function main: %s is not a binary output file\n",argv[1]);
+		exit(1);
+	}
+	N = header.N; n = header.n;
+	if(header.test == BINOUT_TEST_UNCONDITIONAL){
+		loggamma = (double *)malloc((N+1)*sizeof(double));
+		if(!loggamma){
+			fprintf(stderr,"Error in function main: couldn't allocate memory for array loggamma\n");
+			exit(1);
+		}
+		for(i=0; i<=N; i++) loggamma[i] = lgamma(i+1);
+	}
+	itemset_siz = 64;
+	itemset = (int32_t *)malloc(itemset_siz*sizeof(int32_t));
+	if(!itemset){
+		fprintf(stderr,"Error in function main: couldn't allocate memory for array itemset\n");
+		exit(1);
+	}
+
+	itemsets_file = open_output(argv[2],"_sig_itemsets.txt");
+	pvalues_file = open_output(argv[2],"_sig_pvalues.txt");
+	if(header.test == BINOUT_TEST_UNCONDITIONAL) fprintf(pvalues_file,"a1,a0,x,p0,pvalue_lb,p_value_ub\n");
+	else fprintf(pvalues_file,"a1,a0,x,pvalue\n");
+
+	// Both kinds of record start with an int32_t telling them apart
+	while(read_bytes(&tag,sizeof(int32_t))){
+		if(tag == BINOUT_TAG_PVALUE){
+			r_pvalue.tag = tag;
+			read_bytes(((char *)&r_pvalue)+sizeof(int32_t),sizeof(BINOUT_PVALUE)-sizeof(int32_t));
+			if(header.test == BINOUT_TEST_UNCONDITIONAL)
+				fprintf(pvalues_file,"%d,%d,%d,%e,%e,%e\n",r_pvalue.a,r_pvalue.x-r_pvalue.a,r_pvalue.x,computeP0(r_pvalue.x,r_pvalue.a),r_pvalue.p_lo,r_pvalue.p_hi);
+			else fprintf(pvalues_file,"%d,%d,%d,%.18e\n",r_pvalue.a,r_pvalue.x-r_pvalue.a,r_pvalue.x,r_pvalue.p_lo);
+		}
+		else{
+			r_itemset.prefix = tag;
+			read_bytes(((char *)&r_itemset)+sizeof(int32_t),sizeof(BINOUT_ITEMSET)-sizeof(int32_t));
+			if(r_itemset.prefix > len){
+				fprintf(stderr,"Error in function main: corrupted binary file\n");
+				exit(1);
+			}
+			len = r_itemset.prefix + r_itemset.n_new;
+			if(len > itemset_siz){
+				while(len > itemset_siz) itemset_siz *= 2;
+				itemset = (int32_t *)realloc(itemset,itemset_siz*sizeof(int32_t));
+				if(!itemset){
+					fprintf(stderr,"Error in function main: couldn't allocate memory for array itemset\n");
+					exit(1);
+				}
+			}
+			read_bytes(itemset+r_itemset.prefix,r_itemset.n_new*sizeof(int32_t));
+			if(!(r_itemset.n_new & 1)) read_bytes(&pad,sizeof(int32_t));
+			for(i=0; i<len; i++) fprintf(itemsets_file,"%d ",itemset[i]);
+			fprintf(itemsets_file,"(%d)\n",r_itemset.frq);
+		}
+	}
+
+	fclose(bin_file); fclose(itemsets_file); fclose(pvalues_file);
+	free(itemset); free(loggamma);
+	return 0;
+}
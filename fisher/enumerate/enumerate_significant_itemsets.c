@@ -14,6 +14,7 @@
 #include"var_declare.h"
 #include"transaction_keeping.c"
 #include"lcm_var.c"
+#include"stat_tests.h"
 
 /* CONSTANT DEFINES */
 #define READ_BUF_SIZ 524288 //Size of the buffer to read chars from file
@@ -49,6 +50,8 @@ void loggamma_init();
 void psi_init();
 void get_N_n(char *);
 void read_labels_file(char *, char*);
+void pval_tables_init();
+void pval_tables_end();
 extern void LCMFREQ_output_itemset(int *);
 // Profiling variables
 unsigned long n_significant_patterns;
@@ -63,7 +66,9 @@ void enum_sig_itemsets_init(double sig_th, char *labels_file){
 	int j; //Loop variable
 	char *labels_buffer;
 
+	INSTR_BEGIN(INSTR_LOAD);
 	get_N_n(labels_file);
+	INSTR_END(INSTR_LOAD);
 
 	// Store core constants
 	N_over_2 = (N % 2) ? (N-1)/2 : N/2;//floor(N/2)
@@ -86,7 +91,9 @@ void enum_sig_itemsets_init(double sig_th, char *labels_file){
 
 	// Read file containing class labels and store them in array labels, taking care of removing labels
 	// associated with empty transactions
+	INSTR_BEGIN(INSTR_LOAD);
 	read_labels_file(labels_file,labels_buffer);
+	INSTR_END(INSTR_LOAD);
 	// Ensure class 1 is the minority class
 	if(n > (N/2)){
 		for(j=0; j<N; j++) labels_buffer[j] = !labels_buffer[j];
@@ -99,10 +106,17 @@ void enum_sig_itemsets_init(double sig_th, char *labels_file){
 	free(labels_buffer);
 	// The array containing the indices of all non-empty transactions is no longer needed
 	free(non_empty_trans_idx);
+	// Cell counts are accumulated from the number of positives of each merged transaction
+	TRANS_LIST_COUNT_POSITIVES(&root_trans_list,labels);
 
 	// Initialise cache for log(x!) and psi(x)
 	loggamma_init();
 	psi_init();
+	pval_tables_init();
+
+	#ifdef STAT_TESTS
+	stat_tests_init(sig_th);
+	#endif
 
 	// Initialise profiling variables
 	n_significant_patterns = 0;
@@ -177,18 +191,25 @@ void enum_sig_itemsets_end(){
 	fprintf(results_file,"\t Corrected significance threshold: %e\n",delta);
 	fprintf(results_file,"\t LCM support: %d\n",LCM_th);
 	fprintf(results_file,"\t Number of significant patterns found: %lu\n",n_significant_patterns);
+	#ifdef STAT_TESTS
+	stat_tests_end();
+	#endif
 
 	fprintf(stderr, "Tested patterns %lu\n", explored_patterns);
 	fprintf(stderr, "Number of significant patterns found: %lu\n",n_significant_patterns);
 
 	// Free allocated memory
 	free(loggamma); free(psi);
+	pval_tables_end();
 	free(labels);
 
 	// Close output files
 	fclose(results_file);
-	fclose(significant_itemsets_output_file);
-	fclose(pvalues_output_file);
+	if(binary_output) binout_close();
+	else{
+		fclose(significant_itemsets_output_file);
+		fclose(pvalues_output_file);
+	}
 }
 
 inline double sumlogs(double first_log , double second_log){
@@ -206,52 +227,48 @@ inline double logbincoeff(int n_, int k_){
 
 /* --------------------------------FUNCTIONS TO EVALUATE FISHER'S EXACT TEST P-VALUES ------------------------------------ */
 
-/* Evaluate Fisher's exact test on a table with margins x, n and N and cell count a. Note that n and N are defined as global variables.
- * The p-value is defined as a two-tailed p-value which adds up the probabilities of all tables less or equally likely to occur than the
- * one we observed
- */
-double fisher_pval(int a, int x){
-	int a_min, a_max, k;
-	double p_left, p_right, pval;
-	double pre_comp_xterms;
-
-	// Compute the contribution of all terms depending on x but not on a
-	pre_comp_xterms = loggamma[x] + loggamma[N-x];
-	a_min = ((n+x-N) > 0) ? (n+x-N) : 0;//max(0,n+x-N)
-	a_max = (x > n) ? n : x;//min(x,n)
-
-	// The algorithm to compute the p-value proceeds as follows. We inspect simultaneously probability values on the left and right tails of the
-	// hypergeometric distribution, "accepting" each time the one that is smaller. When that happens, we move the index in the appropriate direction,
-	// that is, a_min++ if we "accept" a value on the left and a_max-- if we "accept" a value on the right. As soon as the "accepted" value is located
-	// in index a, we know that we have already explored all values of the hypergeometric probability mass whose probabilities are smaller or equal
-	// than the probability of a. The only tricky case occurs when the probability values on both sides happen to be identical. The way to handle
-	// that case is by "accepting" both values simultaneously.
-	pval = -999999999; //Accumulate probabilities in this variable
-	while(a_min<a_max){
-		p_left = (pre_comp_xterms + log_inv_binom_N_n - (loggamma[a_min] + loggamma[n-a_min] + loggamma[x-a_min] + loggamma[(N-n)-(x-a_min)]));
-		p_right = (pre_comp_xterms + log_inv_binom_N_n - (loggamma[a_max] + loggamma[n-a_max] + loggamma[x-a_max] + loggamma[(N-n)-(x-a_max)]));
-		if(p_left == p_right) {
-			//pval += (p_left+p_right);
-			pval = sumlogs(pval , p_left);
-			pval = sumlogs(pval , p_right);
-			if((a==a_min) || (a==a_max)) return pval;
-			a_min++; a_max--;
-		}
-		else if(p_left < p_right){
-			//pval += p_left;
-			pval = sumlogs(pval , p_left);
-			if(a==a_min) return pval;
-			a_min++;
-		}
-		else{
-			//pval += p_right;
-			pval = sumlogs(pval , p_right);
-			if(a==a_max) return pval;
-			a_max--;
-		}
+// Fisher's exact test p-values, read from per-margin tables
+#include"fisher_pval_table.c"
+// Additional tests evaluated in the same traversal
+#include"stat_tests.c"
+
+/* -------------------------------- METRICS (metrics.c) ----------------------------------------- */
+
+void metrics_config(){
+	metrics_int("N",N);
+	metrics_int("n",n);
+	metrics_double("corrected_significance_threshold",delta);
+	metrics_int("minimum_testable_support",LCM_th);
+	metrics_string("trsact_order",trsact_order_names[trsact_order]);
+	metrics_string("shrink",shrink_names[shrink_mode]);
+	metrics_int("shrink_threads",shrink_threads);
+	cons_metrics();
+}
+
+void metrics_counters(){
+	metrics_int("LCM_iters",LCM_iters);
+	metrics_int("explored_patterns",explored_patterns);
+	metrics_int("n_significant_patterns",n_significant_patterns);
+	#ifdef STAT_TESTS
+	#define STAT_TEST_METRICS(name) metrics_int(#name "_n_significant",name##_n_significant);
+	FOR_EACH_STAT_TEST(STAT_TEST_METRICS)
+	#endif
+}
+
+/* -------------------------------- CHECKPOINTS (checkpoint.c) ----------------------------------------- */
+
+// Counters, and lengths of the output files
+void checkpoint_state(){
+	checkpoint_data(&explored_patterns,sizeof(explored_patterns));
+	checkpoint_data(&n_significant_patterns,sizeof(n_significant_patterns));
+	if(binary_output) binout_checkpoint();
+	else{
+		checkpoint_output_file(significant_itemsets_output_file);
+		checkpoint_output_file(pvalues_output_file);
 	}
-	// If we get to this part of the code, it means is the mode of the distribution and, therefore, its associated p-value is 1
-	return 1;
+	#ifdef STAT_TESTS
+	stat_tests_checkpoint();
+	#endif
 }
 
 /* -------------------FUNCTIONS TO PROCESS A NEWLY FOUND TESTABLE HYPOTHESIS-------------------------------------- */
@@ -276,29 +293,35 @@ double fisher_pval(int a, int x){
 /* Process a solution involving the bitmap represented itemsets */
 // x = frequency (i.e. number of occurrences) of newly found solution
 void bm_process_solution(int x, int item, int *mask){
-	int i,j;//Loop iterators
 	int a; //Cell count of current itemset
 	double pval;//P-value of current itemset
 
 	// Sanity-check
 	if (x != current_trans.siz) printf("Error: x = %d, current_trans.siz=%d\n",x,current_trans.siz);
 
+	// Compute the cell-count corresponding to the current itemset
+	a = current_trans.pos;
+	#ifdef STAT_TESTS
+	// The additional tests run on every hypothesis visited by the traversal, before the filter of the main test
+	stat_tests_process(x,a);
+	#endif
+
 	// Minimum attainable P-value for the hypothesis
 	double psi_x = psi[x];
 	// Check if the newly found solution is in the current testable region Sigma_k
 	if(psi_x > delta) return;
 
-	// Compute the cell-count corresponding to the current itemset
-	a = 0;
-	for(i=0; i<current_trans.siz; i++) a += labels[current_trans.list[i]];
 	// Compute the corresponding p-value
-	pval = exp(fisher_pval(a,x));
+	pval = fisher_pval_table(a,x);
 	// If p-value is significant, write current itemset and the corresponding p-value to the output files
 	explored_patterns++;
 	if(pval <= delta){
 		n_significant_patterns++;
-		fprintf(pvalues_output_file,"%d,%d,%d,%.18e\n",a,x-a,x,pval);
+		INSTR_BEGIN(INSTR_OUTPUT);
+		if(binary_output) binout_pvalue(x,a,pval,pval);
+		else fprintf(pvalues_output_file,"%d,%d,%d,%.18e\n",a,x-a,x,pval);
 		fprintf_current_itemset();
+		INSTR_END(INSTR_OUTPUT);
 	}
 
 
@@ -307,29 +330,65 @@ void bm_process_solution(int x, int item, int *mask){
 /* Process a solution involving the most frequent item (item 0) */
 // x = frequency (i.e. number of occurrences) of newly found solution
 void process_solution0(int x){
-	int i,j;//Loop iterators
 	int a; //Cell count of current itemset
 	double pval;//P-value of current itemset
 
 	// Sanity-check
 	if (x != bm_trans_list[1].siz) printf("Error: x = %d, bm_trans_list[1].siz=%d\n",x,bm_trans_list[1].siz);
 
+	// Compute the cell-count corresponding to the current itemset
+	a = bm_trans_list[1].pos;
+	#ifdef STAT_TESTS
+	// The additional tests run on every hypothesis visited by the traversal, before the filter of the main test
+	stat_tests_process(x,a);
+	#endif
+
 	// Minimum attainable P-value for the hypothesis
 	double psi_x = psi[x];
 	// Check if the newly found solution is in the current testable region Sigma_k
 	if(psi_x > delta) return;
 
-	// Compute the cell-count corresponding to the current itemset
-	a = 0;
-	for(i=0; i<bm_trans_list[1].siz; i++) a += labels[bm_trans_list[1].list[i]];
 	// Compute the corresponding p-value
-	pval = exp(fisher_pval(a,x));
+	pval = fisher_pval_table(a,x);
 	// If p-value is significant, write current itemset and the corresponding p-value to the output files
 	explored_patterns++;
 	if(pval <= delta){
 		n_significant_patterns++;
-		fprintf(pvalues_output_file,"%d,%d,%d,%.18e\n",a,x-a,x,pval);
+		INSTR_BEGIN(INSTR_OUTPUT);
+		if(binary_output) binout_pvalue(x,a,pval,pval);
+		else fprintf(pvalues_output_file,"%d,%d,%d,%.18e\n",a,x-a,x,pval);
 		LCMFREQ_output_itemset(LCM_add.q+LCM_add.t);
+		INSTR_END(INSTR_OUTPUT);
+	}
+}
+
+/* Process a solution found by the vertical bitset engine (vertical_bitset.c) */
+// x = frequency (i.e. number of occurrences) of newly found solution
+// a = cell count of newly found solution, already computed by the engine
+void vbs_process_solution(int x, int a){
+	double pval;//P-value of current itemset
+
+	#ifdef STAT_TESTS
+	// The additional tests run on every hypothesis visited by the traversal, before the filter of the main test
+	stat_tests_process(x,a);
+	#endif
+
+	// Minimum attainable P-value for the hypothesis
+	double psi_x = psi[x];
+	// Check if the newly found solution is in the current testable region Sigma_k
+	if(psi_x > delta) return;
+
+	// Compute the corresponding p-value
+	pval = fisher_pval_table(a,x);
+	// If p-value is significant, write current itemset and the corresponding p-value to the output files
+	explored_patterns++;
+	if(pval <= delta){
+		n_significant_patterns++;
+		INSTR_BEGIN(INSTR_OUTPUT);
+		if(binary_output) binout_pvalue(x,a,pval,pval);
+		else fprintf(pvalues_output_file,"%d,%d,%d,%.18e\n",a,x-a,x,pval);
+		fprintf_current_itemset();
+		INSTR_END(INSTR_OUTPUT);
 	}
 }
 
@@ -338,37 +397,51 @@ void process_solution0(int x){
 // L = pointer to TRANS_LIST struct keeping track of merged transactions
 // item = current node of the tree
 void ary_process_solution(int x, TRANS_LIST *L, int item, int *mask){
-	int j;//Loop iterator
-	int aux; //Auxiliary counter
-	int *t, *t_end, *ptr, *end_ptr; //Pointers for iterating on transaction list
+	int *t, *t_end; //Pointers for iterating on transaction list
 	int a; //Cell count of current itemset
 	double pval;//P-value of current itemset
 
 	/* First, process the new hypothesis */
 
-	// Minimum attainable P-value for the hypothesis
-	double psi_x = psi[x];
-	// Check if the newly found solution is in the current testable region Sigma_k
-	if(psi_x > delta) return;
-
-	// Compute the cell-count corresponding to the current itemset, plus sanity-check
-	a = 0; aux = 0;
+	// Compute the cell-count corresponding to the current itemset as a sum over merged transactions
+	a = 0;
+	for(t=LCM_Os[item],t_end=LCM_Ot[item];t<t_end;t++) a += L->pos[*t];
+	#ifdef DEBUG_TRANSACTION_KEEPING
+	// Sanity-check against the original transactions
+	int aux; //Auxiliary counter
+	int *ptr, *end_ptr; //Pointers for iterating on the original transactions of a merged transaction
+	int a_check = 0; aux = 0;
 	for(t=LCM_Os[item],t_end=LCM_Ot[item];t<t_end;t++){
 		end_ptr = (*t == (L->siz2-1)) ? L->list + L->siz1 : L->ptr[*t+1];
 		for(ptr = L->ptr[*t];ptr < end_ptr;ptr++){
-			a += labels[*ptr];
+			a_check += labels[*ptr];
 			aux++;
 		}
 	}
 	if (x != aux) printf("Error: x = %d, trans_size=%d\n",x,aux);
+	if (a != a_check) printf("Error: a = %d, positives in trans list=%d\n",a,a_check);
+	#endif
+	#ifdef STAT_TESTS
+	// The additional tests run on every hypothesis visited by the traversal, before the filter of the main test
+	stat_tests_process(x,a);
+	#endif
+
+	// Minimum attainable P-value for the hypothesis
+	double psi_x = psi[x];
+	// Check if the newly found solution is in the current testable region Sigma_k
+	if(psi_x > delta) return;
+
 	// Compute the corresponding p-value
-	pval = exp(fisher_pval(a,x));
+	pval = fisher_pval_table(a,x);
 	// If p-value is significant, write current itemset and the corresponding p-value to the output files
 	explored_patterns++;
 	if(pval <= delta){
 		n_significant_patterns++;
-		fprintf(pvalues_output_file,"%d,%d,%d,%.18e\n",a,x-a,x,pval);
+		INSTR_BEGIN(INSTR_OUTPUT);
+		if(binary_output) binout_pvalue(x,a,pval,pval);
+		else fprintf(pvalues_output_file,"%d,%d,%d,%.18e\n",a,x-a,x,pval);
 		fprintf_current_itemset();
+		INSTR_END(INSTR_OUTPUT);
 	}
 
 }
@@ -174,7 +174,7 @@ int FASTI_int_ (){
        *deg to maximum size of rows
        *eles to #items                                           */
 /*****************************************************************/
-ARY FASTI_count ( char *filename, int *rows, int *eles, int *deg ){
+ARY FASTI_count ( char *filename, int *rows, COUNT_INT *eles, int *deg ){
   ARY E;
   int item, i;
 char ch;
@@ -31,7 +31,7 @@ void LCM_BM_init (){
   malloc2 (LCM_BM_highbit, char, LCM_BM_space, "LCM_BM_init: LCM_BM_highbit");
   if ( LCM_PROBLEM == LCM_CLOSED ){
     malloc2 (LCM_BM_pt, int, LCM_BM_space, "LCM_BM_init: LCM_BM_pt");
-    malloc2 (LCM_BM_pp, int, LCM_BM_space, "LCM_BM_init: LCM_BM_pt");
+    malloc2 (LCM_BM_pp, int, LCM_BM_space, "LCM_BM_init: LCM_BM_pp");
     malloc2 (LCM_BM_pq, QUEUE_INT*, LCM_BM_space, "LCM_BM_init: LCM_BM_pq");
     BUF_init ( &LCM_B, sizeof(int), 10000 );
   }
@@ -163,7 +163,7 @@ void LCMclosed_BM_occ_deliver_proc (int p, int pp){
   }
   LCM_BM_weight[p] += LCM_BM_weight[pp];
   /* MODIFICATION TO KEEP TRACK OF TRANSACTIONS */
-  BM_TRANS_LIST_INSERT(p,bm_trans_list[pp].list,bm_trans_list[pp].siz);
+  BM_TRANS_LIST_INSERT(p,bm_trans_list[pp].list,bm_trans_list[pp].siz,bm_trans_list[pp].pos);
   /* END OF MODIFICATION */
 }
 void LCMclosed_BM_occ_deliver_first_proc (QUEUE *Q, int mask, int imax){
@@ -279,7 +279,7 @@ void LCMclosed_BM_occurrence_deliver_first (int item, ARY *T, TRANS_LIST *trans_
     	/* MODIFICATION TO KEEP TRACK OF TRANSACTIONS */
     	//Insert all the original transactions of transaction t into the appropriate queue in BM_TRANS_LIST (node given by the masked bitmap prefix of the transaction TQ[t].s&m)
     	//The last argument is simply the number of elements to be inserted, which has to take care of checking whether we are inserting the last transaction (boundary case) or not
-    	BM_TRANS_LIST_INSERT(TQ[t].s&m,trans_list->ptr[t],(t==(trans_list->siz2-1)) ? (trans_list->list + trans_list->siz1) - trans_list->ptr[t] : trans_list->ptr[t+1] - trans_list->ptr[t]);
+    	BM_TRANS_LIST_INSERT(TQ[t].s&m,trans_list->ptr[t],(t==(trans_list->siz2-1)) ? (trans_list->list + trans_list->siz1) - trans_list->ptr[t] : trans_list->ptr[t+1] - trans_list->ptr[t],trans_list->pos[t]);
     	/* END OF MODIFICATIONS */
     }
   } else {
@@ -289,7 +289,7 @@ void LCMclosed_BM_occurrence_deliver_first (int item, ARY *T, TRANS_LIST *trans_
     	/* MODIFICATION TO KEEP TRACK OF TRANSACTIONS */
 		//Insert all the original transactions of transaction *t into the appropriate queue in BM_TRANS_LIST (node given by the masked bitmap prefix of the transaction TQ[t].s&m)
 		//The last argument is simply the number of elements to be inserted, which has to take care of checking whether we are inserting the last transaction (boundary case) or not
-        BM_TRANS_LIST_INSERT(TQ[*t].s&m,trans_list->ptr[*t],(*t==(trans_list->siz2-1)) ? (trans_list->list + trans_list->siz1) - trans_list->ptr[*t] : trans_list->ptr[*t+1] - trans_list->ptr[*t]);
+        BM_TRANS_LIST_INSERT(TQ[*t].s&m,trans_list->ptr[*t],(*t==(trans_list->siz2-1)) ? (trans_list->list + trans_list->siz1) - trans_list->ptr[*t] : trans_list->ptr[*t+1] - trans_list->ptr[*t],trans_list->pos[*t]);
 		/* END OF MODIFICATIONS */
     }
   }
@@ -330,7 +330,7 @@ int LCM_BM_rm_infreq(int item, int *pmask){
 /* return #all freq items */
 /*************************************************************************/
 // LAST TWO ARGUMENTS ADDED FOR TRANSACTION KEEPING
-int LCM_mk_freq_trsact(ARY *TT, ARY *T, QUEUE_INT item, QUEUE_INT max_item, int cnt, int mask, TRANS_LIST *old_trans_list, TRANS_LIST *new_trans_list){
+COUNT_INT LCM_mk_freq_trsact(ARY *TT, ARY *T, QUEUE_INT item, QUEUE_INT max_item, COUNT_INT cnt, int mask, TRANS_LIST *old_trans_list, TRANS_LIST *new_trans_list){
   QUEUE_INT *x, *buf, *bbuf, *b;
   QUEUE *Q=T->h, *QQ;
   int i, ii, n=0, imax=-1, flag, jt=LCM_jump.t, *t, *t_end;
@@ -372,6 +372,7 @@ int LCM_mk_freq_trsact(ARY *TT, ARY *T, QUEUE_INT item, QUEUE_INT max_item, int
       buf++;
       /* MODIFICATIONS FOR KEEPING TRACK OF TRANSACTIONS */
       new_trans_list->ptr[n] = trans_list_buf;
+      new_trans_list->pos[n] = old_trans_list->pos[*t];
       n_items_cpy = (*t == (old_trans_list->siz2-1)) ? (old_trans_list->list + old_trans_list->siz1) -old_trans_list->ptr[*t] : old_trans_list->ptr[*t+1]-old_trans_list->ptr[*t];
 	  memcpy(trans_list_buf,old_trans_list->ptr[*t],sizeof(int)*n_items_cpy);
 	  new_trans_list->siz1 += n_items_cpy;
@@ -17,8 +17,9 @@
 /*     FASTO_perm to permutation of items ( sorted by frq )   */
 /* set LCM_Eend to #frq items (maximum index of item +1 )     */
 /**************************************************************/
-int LCM_BM_load(char *filename){
-  int e, i, bnum, item, transaction_num, m, zz; /* max item, sum of #items */
+COUNT_INT LCM_BM_load(char *filename){
+  COUNT_INT bnum;
+  int e, i, item, transaction_num, m, zz; /* max item, sum of #items */
   QUEUE_INT *ibuf, *b;  /* buffer for storing all items */
   char ch;
     /* first pass of input file. compute the frequency of each item, 
@@ -26,7 +27,7 @@ int LCM_BM_load(char *filename){
        the re-numbered number of infrequent items are set to -1 */
   ARY E = FASTI_count(filename, &LCM_trsact_num, &bnum, &m);
   if(LCM_print_flag & 2)
-     printf("database: #transactions=%d, #item=%d #elements=%d\n", LCM_trsact_num, E.num, bnum);
+     printf("database: #transactions=%d, #item=%d #elements="COUNT_FMT"\n", LCM_trsact_num, E.num, bnum);
   int *Eq = E.h;
   FASTO_perm = TRSACT_sort_item_by_frq(&E, LCM_th, &bnum, &LCM_Eend);
 
@@ -55,7 +56,7 @@ int LCM_BM_load(char *filename){
   BM_TRANS_LIST_INIT(LCM_BM_MAXITEM);
   /* END OF MODIFICATIONS */
   if(LCM_print_flag & 2)
-     printf ("Reduced %d, #items in BitMap= %d %d\n", z*2, LCM_BM_MAXITEM);
+     printf ("Reduced %lld, #items in BitMap= %d\n", z*2, LCM_BM_MAXITEM);
   for(bnum=item=0; item<LCM_Eend; item++){
     if(Eq[FASTO_perm[item]] < LCM_th) Eq[FASTO_perm[item]] = -1;
       /* if item FASTO_perm[item] is infrequent, set Eq[FASTO_perm[item]]=-1 */
@@ -166,10 +167,16 @@ void LCM_additem(int item){
   /* MODIFICATIONS TO KEEP TRACK OF CURRENT ITEMSET */
   current_itemset[LCM_itemsett] = item;
   /* END OF MODICATIONS */
+  /* MODIFICATIONS FOR ITEMSET CONSTRAINTS (constraints.c) */
+  cons_additem(item);
+  /* END OF MODIFICATIONS */
   LCM_itemsett++;
 }
 void LCM_delitem(){
   LCM_itemsett--;
+  /* MODIFICATIONS FOR ITEMSET CONSTRAINTS (constraints.c) */
+  cons_delitem();
+  /* END OF MODIFICATIONS */
   if(LCM_print_flag&1) LCM_p = LCM_itemsetp[LCM_itemsett];
 }
 
@@ -185,8 +192,19 @@ void LCM_output_itemset(){
   FASTO_flush_();
 }
 
+/* MODIFICATIONS FOR STREAMING METRICS (metrics.c) AND PROGRESS REPORTS (progress.c) */
+#include<signal.h>
+extern volatile sig_atomic_t metrics_due, progress_due;
+void metrics_stream();
+void progress_write();
+/* END OF MODIFICATIONS */
+
 /* process when find a solution */
 void LCM_solution(){
+  /* MODIFICATIONS FOR STREAMING METRICS AND PROGRESS REPORTS */
+  if(metrics_due) metrics_stream();
+  if(progress_due) progress_write();
+  /* END OF MODIFICATIONS */
 #ifdef LCM_OVERTIME_END
   if ( time(NULL)-LCM_start_time > LCM_maximum_time ){
     printf ("time over\n"); exit(1); }
@@ -234,7 +252,12 @@ void LCM_print_last(int item, int frq){
   LCM_additem(item);
   LCMFREQ_solution();
   /* MODIFICATION FOR WY ALGORITHM */
-  process_solution0(LCM_frq);
+  // Only admissible itemsets are processed (constraints.c)
+  if(cons_admissible()){
+    INSTR_BEGIN(INSTR_TEST);
+    process_solution0(LCM_frq);
+    INSTR_END(INSTR_TEST);
+  }
   /* END OF MODIFICATIONS */
   /* MODIFICATION TO KEEP TRACK OF TRANSACTIONS */
   //print_trans0();
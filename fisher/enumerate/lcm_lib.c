@@ -39,9 +39,10 @@ int LCM_jump_rm_infreq(int item){
    2. set jump to the list of items i s.t. at least one occurrence of occ 
       includes i.   */
 /*************************************************************************/
-int LCM_freq_calc(ARY *T, int item, int max_item){
+COUNT_INT LCM_freq_calc(ARY *T, int item, int max_item){
   QUEUE_INT *x, *jq=&(LCM_jump.q[LCM_jump.t]);
-  int ee, n=0, *t, *t_end;
+  int ee, *t, *t_end;
+  COUNT_INT n=0;
   QUEUE *Q = T->h;
   if(T->num < LCM_Eend){
     for(t=LCM_Os[item],t_end=LCM_Ot[item]; t<t_end; t++){
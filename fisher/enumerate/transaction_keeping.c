@@ -5,6 +5,7 @@
 //Need access to some internal LCM variables
 #include"transaction_keeping.h"
 #include"var_declare.h"
+#include"binary_output.c"
 
 /* MACROS */
 // Compute rounded up integer of quotient a/b
@@ -42,15 +43,24 @@ void TRANS_LIST_INIT(TRANS_LIST *L,int siz1,int siz2){
 		fprintf(stderr,"Error in function TRANS_LIST_INIT: couldn't allocate memory for array L->ptr\n");
 		exit(1);
 	}
+	L->pos = (int *)malloc(siz2*sizeof(int));
+	if(!L->pos){
+		fprintf(stderr,"Error in function TRANS_LIST_INIT: couldn't allocate memory for array L->pos\n");
+		exit(1);
+	}
 }
 
 void TRANS_LIST_END(TRANS_LIST *L){
 	free(L->list);
 	free(L->ptr);
+	free(L->pos);
 }
 
 void BM_TRANS_LIST_INIT(int n_items){
-	int i,n_nodes,mem_siz;
+	int i,n_nodes;
+	#ifdef KEEP_CURRENT_TRANS
+	int mem_siz;
+	#endif
 	int l1,l2;
 	//Compute 2^LCM_BM_MAXITEM
 	for(i=0,n_nodes=1;i<n_items;i++,n_nodes*=2);
@@ -64,27 +74,41 @@ void BM_TRANS_LIST_INIT(int n_items){
 	//The (i+1)-th most frequent item has 2^i nodes, hence each node gets a share
 	//of frq[i]/2^i *sizeof(int) bytes
 	for(i=0,l1=1,l2=2;i<n_items;i++,l2*=2){
+		#ifdef KEEP_CURRENT_TRANS
 		mem_siz = CEIL(bitmap_item_frq[i],l1);
 		//mem_siz = bitmap_item_frq[i];
+		#endif
 		for(;l1<l2;l1++){
+			#ifdef KEEP_CURRENT_TRANS
 			bm_trans_list[l1].list = (int *)malloc(mem_siz*sizeof(int));
 			if(!bm_trans_list[l1].list){
 				fprintf(stderr,"Error in function BM_TRANS_LIST_INIT: couldn't allocate memory for array bm_trans_list[l1].list\n");
 				exit(1);
 			}
 			bm_trans_list[l1].max_siz = mem_siz;
+			#else
+			// Without KEEP_CURRENT_TRANS the 2^LCM_BM_MAXITEM nodes only keep their size and positives
+			bm_trans_list[l1].list = ((int *)0);
+			bm_trans_list[l1].max_siz = 0;
+			#endif
 			bm_trans_list[l1].siz = 0;
+			bm_trans_list[l1].pos = 0;
 		}
 	}
 	bm_trans_list_nodes = n_nodes;
 	// Initialize structure to keep current transaction
+	#ifdef KEEP_CURRENT_TRANS
 	current_trans.list = (int *)malloc(bitmap_item_frq[0]*sizeof(int));
 	if(!current_trans.list){
 		fprintf(stderr,"Error in function BM_TRANS_LIST_INIT: couldn't allocate memory for array current_trans.list\n");
 		exit(1);
 	}
+	#else
+	current_trans.list = ((int *)0);
+	#endif
 	current_trans.max_siz = bitmap_item_frq[0];
 	current_trans.siz = 0;
+	current_trans.pos = 0;
 }
 
 void BM_TRANS_LIST_END(){
@@ -94,10 +118,11 @@ void BM_TRANS_LIST_END(){
 	free(bm_trans_list);
 }
 
-void BM_TRANS_LIST_INSERT(int p, int *src, int siz){
-	int new_size;
+void BM_TRANS_LIST_INSERT(int p, int *src, int siz, int pos){
 	// If p==0, the transaction does not belong in the CPT
 	if(p==0) return;
+	#ifdef KEEP_CURRENT_TRANS
+	int new_size;
 	// Check if current list size if big enough to fit new data
 	// If not, allocate double the current memory size
 	new_size = bm_trans_list[p].siz + siz;
@@ -111,22 +136,44 @@ void BM_TRANS_LIST_INSERT(int p, int *src, int siz){
 		bm_trans_list[p].max_siz = new_size;
 	}
 	memcpy(bm_trans_list[p].list + bm_trans_list[p].siz,src,siz*sizeof(int));
+	#else
+	(void)src; // Only the size and the positives of the transactions are kept
+	#endif
 	bm_trans_list[p].siz += siz;
+	bm_trans_list[p].pos += pos;
 }
 
 void BM_TRANS_LIST_EMPTY(int p){
 	bm_trans_list[p].siz = 0;
+	bm_trans_list[p].pos = 0;
 }
 
 void BM_CURRENT_TRANS_INSERT(int p){
+	// The cell counts only need the size and the number of positives of the list, so the original
+	// transaction IDs are copied only if KEEP_CURRENT_TRANS is defined (e.g. to print them)
+	#ifdef KEEP_CURRENT_TRANS
 	// This list can never overflow its initially allocated size, equal to the frequency of the
 	// most frequent item
 	memcpy(current_trans.list + current_trans.siz,bm_trans_list[p].list,bm_trans_list[p].siz*sizeof(int));
+	#endif
 	current_trans.siz += bm_trans_list[p].siz;
+	current_trans.pos += bm_trans_list[p].pos;
+}
+
+// Count the positives of each merged transaction of L. Needs to be called once the class labels are
+// available, as LCM_init shrinks root_trans_list before they are read
+void TRANS_LIST_COUNT_POSITIVES(TRANS_LIST *L, char *labels){
+	int t, *ptr, *end_ptr;
+	for(t=0;t<L->siz2;t++){
+		end_ptr = (t == (L->siz2-1)) ? L->list + L->siz1 : L->ptr[t+1];
+		L->pos[t] = 0;
+		for(ptr = L->ptr[t];ptr < end_ptr;ptr++) L->pos[t] += labels[*ptr];
+	}
 }
 
 void BM_CURRENT_TRANS_EMPTY(){
 	current_trans.siz = 0;
+	current_trans.pos = 0;
 }
 
 /* INITIALIZATION AND TERMINATION FUNCTIONS */
@@ -143,6 +190,7 @@ void transaction_keeping_init(char *trans_file){
 	for(i=0;i<LCM_Trsact.num;i++){
 		root_trans_list.list[i] = i;
 		root_trans_list.ptr[i] = &root_trans_list.list[i];
+		root_trans_list.pos[i] = 0;
 	}
 
 	workspace1 = (int *)malloc(LCM_Trsact.num*sizeof(int));
@@ -209,6 +257,10 @@ void remove_empty_transactions(char *trans_file){
 
 void fprintf_current_itemset(){
 	int i;
+	if(binary_output){
+		binout_itemset(current_itemset,LCM_itemsett,LCM_frq);
+		return;
+	}
 	for(i=0; i<LCM_itemsett; i++) {
 		fprintf(significant_itemsets_output_file,"%d ",FASTO_perm[current_itemset[i]]);
 	}
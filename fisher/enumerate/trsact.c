@@ -16,6 +16,14 @@
 #include"transaction_keeping.c"
 /* END OF MODIFICATIONS */
 
+/* MODIFICATIONS FOR TRANSACTION REORDERING */
+#include"trsact_order.c"
+/* END OF MODIFICATIONS */
+
+/* MODIFICATIONS FOR HASH-BASED REDUCTION */
+#include"shrink_hash.c"
+/* END OF MODIFICATIONS */
+
 /***********************************/
 /*   print transactions            */
 /***********************************/
@@ -40,7 +48,7 @@ void TRSACT_print ( ARY *T ){
 /* set *num to the size of database composed only of frequent items */
 /* set *Enum to #frequent items                                     */
 /********************************************************************/
-int *TRSACT_sort_item_by_frq ( ARY *E, int th, int *num, int *Enum ){
+int *TRSACT_sort_item_by_frq ( ARY *E, int th, COUNT_INT *num, int *Enum ){
   int *Eq = E->h, *perm, i;
   *num = 0;
   *Enum = 0;
@@ -123,6 +131,9 @@ void LCM_shrink_init (ARY *T, QUEUE_INT Eend){
   for ( i=0 ; i<Eend*2+2 ; i++ ) LCM_shrink_p[i] = -1;
   QUEUE_init ( &LCM_shrink_jump, Eend*2+2 );
   LCM_shrink_jump.end = Eend;
+  /* MODIFICATIONS FOR HASH-BASED REDUCTION */
+  shrink_hash_init(T->num);
+  /* END OF MODIFICATIONS */
 }
 
 
@@ -168,6 +179,13 @@ void LCM_shrink(ARY *T, int max_item, int flag, TRANS_LIST *old_trans_list, TRAN
   int counter = 0;
   /* END OF MODIFICATIONS */
 
+  /* MODIFICATIONS FOR HASH-BASED REDUCTION */
+  if(shrink_mode == SHRINK_HASH){
+    LCM_shrink_hash(T, max_item, old_trans_list, new_trans_list);
+    return;
+  }
+  /* END OF MODIFICATIONS */
+
   if(flag&1){  /*  BitMap version */
     LCM_BM_weight[0] = 0;  // it is not cleared in other routines
     for(t=0; t<T->num; t++){
@@ -279,6 +297,7 @@ void LCM_shrink(ARY *T, int max_item, int flag, TRANS_LIST *old_trans_list, TRAN
       /* MODIFICATIONS FOR KEEPING TRACK OF TRANSACTIONS */
       // First copy original transactions of the new transaction t to be added
       new_trans_list->ptr[j] = trans_list_buf;
+      new_trans_list->pos[j] = old_trans_list->pos[t];
       n_items_cpy = (t == (old_trans_list->siz2-1)) ? (old_trans_list->list + old_trans_list->siz1) -old_trans_list->ptr[t] : old_trans_list->ptr[t+1]-old_trans_list->ptr[t];
       memcpy(trans_list_buf,old_trans_list->ptr[t],sizeof(int)*n_items_cpy);
 	  trans_list_buf += n_items_cpy;
@@ -289,6 +308,7 @@ void LCM_shrink(ARY *T, int max_item, int flag, TRANS_LIST *old_trans_list, TRAN
 			  n_items_cpy = (*aux_buf == (old_trans_list->siz2-1)) ? (old_trans_list->list + old_trans_list->siz1) -old_trans_list->ptr[*aux_buf] : old_trans_list->ptr[*aux_buf+1]-old_trans_list->ptr[*aux_buf];
 			  memcpy(trans_list_buf,old_trans_list->ptr[*aux_buf],sizeof(int)*n_items_cpy);
 			  trans_list_buf += n_items_cpy;
+			  new_trans_list->pos[j] += old_trans_list->pos[*aux_buf];
 			  aux_buf++;
 		  }
 	  }
@@ -1,3 +1,4 @@
+import json
 import math
 import os
 import numpy as np
@@ -130,25 +131,23 @@ def run_unconditional():
         time.sleep(wait_time)
     os.system(cmd)
     time.sleep(wait_time)
-    patterns = list()
-    results_patterns = ["N = ", "n1 = ","Number of significant patterns found: "]
-    results_patterns.append("Tested patterns ")
-    results_patterns.append("explored_contingency_tables ")
-    results_patterns.append("count_number_of_ci_rejects ")
-    results_patterns.append("count_number_of_simpleub_rejects ")
-    results_patterns.append("count_number_of_enumerate_rejects ")
-    results_patterns.append("count_number_of_enumerate_nonrejects ")
-    results_patterns.append("Total execution time (s): ")
+    # counters and timings of the enumeration, from the metrics document it writes at the end of the run
+    metrics_path = temp_file_path+"_metrics.json"
     res = list()
-    for pattern in results_patterns:
-        #print "checking "+pattern
-        try:
-            returned = float(get_result(pattern , out_path))
-            res.append(returned)
-        except ValueError:
-            print "Problem in unconditional when checking for "+pattern
-            print "DB = "+str(args.db)+" sz = "+str(args.sz)
-            res.append(-1.0)
+    try:
+        metrics = json.load(open(metrics_path,'r'))
+        config = metrics["config"]
+        counters = metrics["counters"]
+        results_values = [config["N"], config["n"], counters["n_significant_patterns"]]
+        for counter in ["explored_patterns", "explored_contingency_tables", "count_number_of_ci_rejects", "count_number_of_simpleub_rejects", "count_number_of_enumerate_rejects", "count_number_of_enumerate_nonrejects"]:
+            results_values.append(counters[counter])
+        results_values.append(metrics["elapsed"]["cpu_s"])
+        for value in results_values:
+            res.append(float(value))
+    except (IOError, ValueError, KeyError):
+        print "Problem in unconditional when reading "+metrics_path
+        print "DB = "+str(args.dataset)+" sz = "+str(args.samplesize)
+        res = [-1.0]*10
     res.append(running_time_amira)
     res.append(epsilon)
     res.append(time_to_correct)
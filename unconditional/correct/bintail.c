@@ -0,0 +1,113 @@
+#ifndef _bintail_c_
+#define _bintail_c_
+
+/* BINOMIAL TAIL PROBABILITIES
+ * P(X >= k) and P(X <= k) for X ~ Bin(n_,pi), replacing the incomplete beta function of incbeta.c for the binomial
+ * tails of the unconditional test (for integer arguments, incbeta(a,b,x) = P(Bin(a+b-1,x) >= a)).
+ * 	- Each tail is computed on the side away from the mean, as the complement of the other one otherwise, so that
+ * 	  the result keeps its relative precision however small it is.
+ * 	- For moderate variances the tail is summed exactly, starting from the probability of k (obtained from the
+ * 	  precomputed loggamma[] instead of lgamma) and moving away from the mean with the ratios of consecutive
+ * 	  probabilities. The ratios decrease, which bounds the rest of the sum, and the summation stops as soon as
+ * 	  that bound is below BINTAIL_EPS times the sum.
+ * 	- For variances above BINTAIL_SADDLEPOINT_VAR the exact sum needs too many terms, and the Lugannani-Rice
+ * 	  saddlepoint approximation with continuity correction is used instead. Its relative error decreases with the
+ * 	  variance and is below 1e-8 at the default threshold.
+ * The results are kept in a direct-mapped cache of 2^BINTAIL_CACHE_LOG2 entries keyed by (n_,k,pi), since the
+ * unconditional test asks for the same tails for every table with the same margin. binomial_tail_upper_batch
+ * evaluates many tails at the same pi, sharing the terms that only depend on pi.
+ *
+ * Needs the global array loggamma, and must therefore be included after it is defined.
+ * */
+
+/* CODE DEPENDENCIES */
+#include<float.h>
+
+/* CONSTANT DEFINES */
+#ifndef BINTAIL_SADDLEPOINT_VAR
+#define BINTAIL_SADDLEPOINT_VAR 1e5 //Variance n_*pi*(1-pi) above which the saddlepoint approximation is used
+#endif
+#ifndef BINTAIL_CACHE_LOG2
+#define BINTAIL_CACHE_LOG2 16 //Base 2 logarithm of the number of entries of the cache
+#endif
+#define BINTAIL_EPS 1e-17 //Relative accuracy of the exact summation
+
+/* TYPES */
+typedef struct {
+	int n, k; // Upper tail P(Bin(n,pi) >= k)
+	double pi;
+	double tail;
+	char valid;
+} BINTAIL_CACHE_ENTRY;
+
+/* GLOBAL VARIABLES */
+BINTAIL_CACHE_ENTRY bintail_cache[1 << BINTAIL_CACHE_LOG2];
+
+/* CORE FUNCTIONS */
+
+/* P(X >= k) for k > n_*pi, by exact summation. r = pi/(1-pi) */
+double bintail_sum(int n_, int k, double log_pi, double log_1_pi, double r){
+	double t, sum, ratio;
+	int j;
+	t = exp((k*log_pi) + ((n_-k)*log_1_pi) + loggamma[n_] - loggamma[n_-k] - loggamma[k]);
+	if(t < DBL_MIN) return t;
+	for(j=k, sum=t; j<n_; j++){
+		ratio = r*(n_-j)/(j+1);
+		// The following terms decrease at least geometrically with this ratio
+		if(t*ratio < BINTAIL_EPS*sum*(1-ratio)) break;
+		t *= ratio;
+		sum += t;
+	}
+	return sum;
+}
+
+/* P(X >= k) for k > n_*pi, by the saddlepoint approximation. Returns a negative value if k is too close to the
+ * mean for the approximation to be accurate
+ * */
+double bintail_saddlepoint(int n_, int k, double pi){
+	double kc = k - 0.5, s, K, w, u;
+	if(kc - n_*pi < 1) return -1;
+	s = log(kc*(1-pi)/(pi*(n_-kc)));
+	K = n_*log((1-pi)*n_/(n_-kc));
+	w = sqrt(2*(s*kc - K));
+	u = 2*sinh(s/2)*sqrt(kc*(n_-kc)/n_);
+	return 0.5*erfc(w/M_SQRT2) + exp(-w*w/2)/sqrt(2*M_PI)*(1/u - 1/w);
+}
+
+/* P(X >= k) for X ~ Bin(n_,pi), with log(pi), log(1-pi) and pi/(1-pi) precomputed by the caller */
+double bintail_upper(int n_, int k, double pi, double log_pi, double log_1_pi, double r){
+	double tail;
+	if(k <= 0) return 1;
+	if(k > n_) return 0;
+	// Lower side of the mean: complement of the lower tail, computed on the upper side of the mean of 1-X
+	if(k <= n_*pi) return 1 - bintail_upper(n_,n_-k+1,1-pi,log_1_pi,log_pi,1/r);
+	if((n_*pi*(1-pi) > BINTAIL_SADDLEPOINT_VAR) && ((tail = bintail_saddlepoint(n_,k,pi)) >= 0)) return tail;
+	return bintail_sum(n_,k,log_pi,log_1_pi,r);
+}
+
+/* P(X >= k) for X ~ Bin(n_,pi), through the cache */
+double binomial_tail_upper(int n_, int k, double pi){
+	BINTAIL_CACHE_ENTRY *entry;
+	unsigned long long h;
+	memcpy(&h,&pi,sizeof(double));
+	h = (h ^ (((unsigned long long)n_) << 32) ^ ((unsigned long long)k))*11400714819323198485ULL;
+	entry = bintail_cache + (h >> (64-BINTAIL_CACHE_LOG2));
+	if(entry->valid && (entry->n == n_) && (entry->k == k) && (entry->pi == pi)) return entry->tail;
+	entry->tail = bintail_upper(n_,k,pi,log(pi),log(1-pi),pi/(1-pi));
+	entry->n = n_; entry->k = k; entry->pi = pi; entry->valid = 1;
+	return entry->tail;
+}
+
+/* P(X <= k) for X ~ Bin(n_,pi), as the upper tail of n_-X ~ Bin(n_,1-pi) */
+double binomial_tail_lower(int n_, int k, double pi){
+	return binomial_tail_upper(n_,n_-k,1-pi);
+}
+
+/* tail[i] = P(X >= k[i]) for X ~ Bin(n_[i],pi), i = 0,...,m-1, for a single value of pi. Bypasses the cache */
+void binomial_tail_upper_batch(int m, int *n_, int *k, double pi, double *tail){
+	double log_pi = log(pi), log_1_pi = log(1-pi), r = pi/(1-pi);
+	int i;
+	for(i=0; i<m; i++) tail[i] = bintail_upper(n_[i],k[i],pi,log_pi,log_1_pi,r);
+}
+
+#endif
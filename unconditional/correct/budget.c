@@ -0,0 +1,234 @@
+#ifndef _budget_c_
+#define _budget_c_
+
+/* BUDGETED CORRECTION
+ * With the optional arguments -time_budget seconds (wall-clock time since the start of the run) and/or
+ * -node_budget iterations (iterations of LCM, LCM_iters), the correction stops cleanly as soon as either budget is
+ * exhausted, instead of running to completion. The results, timing and metrics files are written as at the end of a
+ * complete run, with the state of the correction at the time of the stop, and the process exits with status 0.
+ * At that point
+ * 	- the number of testable patterns m_testable and the LCM support LCM_th are lower bounds, and the P-value threshold
+ * 	  delta an upper bound, on those of the complete run, since the correction only moves them in one direction,
+ * 	- the testable patterns not found yet all lie in the subtrees of the top-level items not completed, i.e. from the
+ * 	  item being explored (progress.c) to LCM_Eend. A closed itemset C of the subtree of item j is j plus items on
+ * 	  one side of it (below j for LCM, above it for the vertical engine), and it is told apart by its tidset, a
+ * 	  union of merged transactions containing j with at least LCM_th transactions. Its items on that side all have
+ * 	  a support of at least LCM_th together with j (the set F_j), and each transaction t of its tidset contains
+ * 	  them, so sum_C supp(C) <= sum_t mult(t)*2^|t & F_j| over the transactions t containing j. Their number is
+ * 	  at most the smallest of sum_{k>=LCM_th} binom(f,k) for j of support f, 2^(#merged transactions containing j),
+ * 	  2^|F_j| and sum_t mult(t)*2^|t & F_j| / LCM_th. Splitting the closed itemsets other than the closure of j by
+ * 	  their item i of F_j closest to j, and bounding those of each i in the same way on the transactions containing i and
+ * 	  j, gives another bound, 1 plus the sum of these, used down to BUDGET_BOUND_DEPTH levels below j. The sum U
+ * 	  of these bounds over the items not completed bounds the testable patterns not found yet. Only the first one
+ * 	  is available in the out-of-core mode, which does not keep the transactions,
+ * 	- every pattern testable at a threshold d <= delta is testable at delta, and there are at most m_testable+U of
+ * 	  them. Hence d = min(delta, alpha/(m_testable+U)) still controls the FWER at level alpha, and is reported as the
+ * 	  corrected significance threshold. Enumerating with it and the reported LCM support is conservative.
+ * U grows exponentially with the length of the transactions of the items left, so the certified threshold is only
+ * useful when the budget runs out close to the end of the mining, or when the items left are rare. The report gives
+ * its ratio to the threshold ignoring U.
+ * Not available in the Westfall-Young mode, whose partial minimum P-values give no bound of this kind.
+ * */
+
+/* CONSTANT DEFINES */
+#define BUDGET_CLOCK_PERIOD 1024 //Number of solutions between two readings of the clock
+#ifndef BUDGET_BOUND_DEPTH
+#define BUDGET_BOUND_DEPTH 1 //Levels below the top-level items over which the bound on the patterns left is refined
+#endif
+
+/* GLOBAL VARIABLES */
+// Budgets, 0 if not set
+double budget_time = 0;
+long long budget_nodes = 0;
+// Set to 1 when the run has been stopped by the budget
+int budget_exhausted = 0;
+// Number of calls of budget_check, to read the clock only every BUDGET_CLOCK_PERIOD of them
+long long budget_calls = 0;
+// Support of each frequent item, in the numbering used by LCM (set by LCM_BM_load)
+int *item_frq;
+// Support for which budget_remaining_bound last computed U, and its value
+int budget_bound_th = -1;
+double budget_bound_u;
+// Work arrays of budget_closed_bound: the supports together with the itemset of each node, and the merged
+// transactions containing it, one array per depth
+int *budget_cs = NULL, *budget_occ = NULL;
+
+/* FUNCTION DECLARATIONS */
+void lamp_end();
+void profileCode();
+// Defined in vertical_bitset.c
+extern int use_vertical_engine;
+// Defined in lcm_bm.c and out_of_core.c
+extern int LCM_BM_MAXITEM;
+extern double ooc_mb;
+
+/* INITIALISATION FUNCTIONS */
+
+/* Parse an optional argument -time_budget or -node_budget of main. Returns 1 if the argument was consumed */
+int budget_option(char *arg, char *value){
+	if(!strcmp(arg,"-time_budget")){
+		budget_time = atof(value);
+		if(budget_time <= 0){
+			fprintf(stderr,"Error in function budget_option: the time budget must be positive\n");
+			exit(1);
+		}
+		return 1;
+	}
+	if(!strcmp(arg,"-node_budget")){
+		budget_nodes = atoll(value);
+		if(budget_nodes <= 0){
+			fprintf(stderr,"Error in function budget_option: the node budget must be positive\n");
+			exit(1);
+		}
+		return 1;
+	}
+	return 0;
+}
+
+/* CORE FUNCTIONS */
+
+/* Returns 1 if a budget has been exhausted. Called by LCM_solution */
+int budget_check(){
+	if(budget_nodes && (LCM_iters >= budget_nodes)) return 1;
+	if(budget_time && !(++budget_calls % BUDGET_CLOCK_PERIOD)) return (measureWallTime()-wt_init >= budget_time);
+	return 0;
+}
+
+/* Upper bound on sum_{k>=th} binom(f,k), or a value of at least cap */
+double budget_binom_bound(int f, int th, double cap){
+	double u = 0;
+	int k;
+	for(k=th; (k<=f) && (u<cap); k++) u += exp(loggamma[f]-loggamma[k]-loggamma[f-k]);
+	return u;
+}
+
+/* Check if the merged transaction t of LCM_Trsact contains item e */
+int budget_trsact_has(int t, int e){
+	QUEUE *Q = LCM_Trsact.h;
+	QUEUE_INT *x;
+	if(e < LCM_BM_MAXITEM) return (Q[t].s & BITMASK_1[e]) != 0;
+	for(x=Q[t].q;*x<e;x++);
+	return *x == e;
+}
+
+/* Upper bound on the number of closed itemsets with support at least th made of the itemset P of the current node,
+ * whose last item is e, and of items on the side of e (below it for LCM, above it for the vertical engine) which
+ * are also in the set F of the parent node (all items at depth 0). occ holds the n_occ merged transactions of
+ * LCM_Trsact containing P. The bound is refined by splitting the itemsets by their next item, down to
+ * BUDGET_BOUND_DEPTH levels below the top-level item
+ * */
+double budget_closed_bound(int e, int depth, int th, int *occ, int n_occ){
+	QUEUE *Q = LCM_Trsact.h;
+	QUEUE_INT *x;
+	int *cs = budget_cs + depth*LCM_Eend, *prev = depth ? cs-LCM_Eend : NULL, *sub;
+	double u = 0, r, cap;
+	int i, k, o, f = 0, n_f = 0, n_sub;
+
+	// Support of each item of the side of e, and in F if depth > 0, together with P. Those of support th or more
+	// make the set F of this node
+	for(o=0;o<n_occ;o++){
+		f += Q[occ[o]].end;
+		for(i=0;i<LCM_BM_MAXITEM;i++) if(Q[occ[o]].s & BITMASK_1[i]) cs[i] += Q[occ[o]].end;
+		for(x=Q[occ[o]].q;*x<LCM_Eend;x++) cs[*x] += Q[occ[o]].end;
+	}
+	for(i=0;i<LCM_Eend;i++){
+		if((use_vertical_engine ? (i <= e) : (i >= e)) || (prev && !prev[i]) || (cs[i] < th)) cs[i] = 0;
+		else n_f++;
+	}
+	// Subsets of the items of F in each transaction, weighted by its multiplicity
+	for(o=0;o<n_occ;o++){
+		for(i=k=0;i<LCM_BM_MAXITEM;i++) if((Q[occ[o]].s & BITMASK_1[i]) && cs[i]) k++;
+		for(x=Q[occ[o]].q;*x<LCM_Eend;x++) if(cs[*x]) k++;
+		u += Q[occ[o]].end*ldexp(1.0,k);
+	}
+	u /= th;
+	cap = ldexp(1.0,(n_f < n_occ) ? n_f : n_occ);
+	if(cap < u) u = cap;
+	r = budget_binom_bound(f,th,u);
+	if(r < u) u = r;
+	// P itself, plus the itemsets whose next item is i, for each i of F
+	if((depth < BUDGET_BOUND_DEPTH) && (u > 1+n_f)){
+		sub = budget_occ + (depth+1)*LCM_Trsact.num;
+		for(i=0, r=1; (i<LCM_Eend) && (r<u); i++){
+			if(!cs[i]) continue;
+			for(o=n_sub=0;o<n_occ;o++) if(budget_trsact_has(occ[o],i)) sub[n_sub++] = occ[o];
+			r += budget_closed_bound(i,depth+1,th,sub,n_sub);
+		}
+		if(r < u) u = r;
+	}
+	for(i=0;i<LCM_Eend;i++) cs[i] = 0;
+	return u;
+}
+
+/* Upper bound on the number of patterns with support at least th not found yet */
+double budget_remaining_bound(int th){
+	double u = 0, u_item, cap;
+	int j, f, t, n, j0 = (progress_item < 0) ? 0 : progress_item;
+
+	if(th == budget_bound_th) return budget_bound_u;
+	// Work arrays of budget_closed_bound (LCM_Trsact is not kept in the out-of-core mode)
+	if(!ooc_mb){
+		budget_cs = (int *)calloc((BUDGET_BOUND_DEPTH+1)*LCM_Eend,sizeof(int));
+		budget_occ = (int *)malloc((BUDGET_BOUND_DEPTH+1)*LCM_Trsact.num*sizeof(int));
+		if(!budget_cs || !budget_occ){
+			fprintf(stderr,"Error in function budget_remaining_bound: couldn't allocate memory for array budget_occ\n");
+			exit(1);
+		}
+	}
+	for(j=j0; j<LCM_Eend; j++){
+		f = item_frq[j];
+		if(f < th) continue;
+		// LCM adds the items below j, the vertical engine those above it
+		cap = ldexp(1.0,use_vertical_engine ? LCM_Eend-1-j : j);
+		if(budget_occ){
+			for(t=n=0;t<LCM_Trsact.num;t++) if(budget_trsact_has(t,j)) budget_occ[n++] = t;
+			u_item = budget_closed_bound(j,0,th,budget_occ,n);
+			if(u_item < cap) cap = u_item;
+		}
+		u_item = budget_binom_bound(f,th,cap);
+		u += (u_item < cap) ? u_item : cap;
+	}
+	free(budget_cs); free(budget_occ);
+	budget_cs = budget_occ = NULL;
+	budget_bound_th = th;
+	budget_bound_u = u;
+	return u;
+}
+
+/* Certified corrected significance threshold of a target FWER with P-value threshold delta_, m_ testable patterns
+ * found and LCM support th
+ * */
+double budget_threshold(double alpha_, double delta_, long long m_, int th){
+	double d = alpha_/(m_ + budget_remaining_bound(th));
+	return (d < delta_) ? d : delta_;
+}
+
+/* Stop the run, ending it as main does after the mining */
+void budget_stop(){
+	budget_exhausted = 1;
+	toc = measureTime();
+	time_threshold_correction = toc-tic; wall_threshold_correction = measureWallTime()-wtic;
+	tic = measureTime(); wtic = measureWallTime();
+	lamp_end();
+	toc = measureTime();
+	time_termination = toc-tic; wall_termination = measureWallTime()-wtic;
+	t_end = measureTime(); wt_end = measureWallTime();
+	profileCode();
+	metrics_end();
+	exit(0);
+}
+
+/* OUTPUT FUNCTIONS */
+
+/* Write the state of the stopped run to the results file, after the results of the driving target FWER */
+void budget_report(FILE *f){
+	fprintf(f,"BUDGET EXHAUSTED\n");
+	fprintf(f,"\t Stopped after: %f (s), %d iterations of LCM\n",measureWallTime()-wt_init,LCM_iters);
+	fprintf(f,"\t Top-level item being explored: %d of %d\n",(progress_item < 0) ? 0 : progress_item,LCM_Eend);
+	fprintf(f,"\t Upper bound on the testable patterns not found yet: %e\n",budget_remaining_bound(LCM_th));
+	fprintf(f,"\t Corrected significance threshold ignoring them (not certified): %e\n",alpha/m_testable);
+	fprintf(f,"\t Ratio of the certified to the non-certified threshold: %e\n",budget_threshold(alpha,delta,m_testable,LCM_th)*m_testable/alpha);
+	fprintf(f,"\t Final LCM support and number of testable patterns are lower bounds, final P-value lower bound is an upper bound\n");
+}
+
+#endif
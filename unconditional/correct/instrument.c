@@ -0,0 +1,200 @@
+#ifndef _instrument_c_
+#define _instrument_c_
+
+/* INSTRUMENTATION
+ * Named timers around the main phases of the mining and of the statistical test, compiled in with -DINSTRUMENT.
+ * Without it, INSTR_INIT, INSTR_BEGIN and INSTR_END expand to nothing. The timers are
+ * 	load     : reading the transactions (LCM_init) and the class labels
+ * 	shrink   : building the conditional databases of the array phase (LCM_mk_freq_trsact and LCM_shrink)
+ * 	bm       : bitmap phase of LCM (LCMclosed_BM_recursive)
+ * 	ary      : array phase of LCM (LCMclosed_iter)
+ * 	vertical : vertical bitset engine (VBS_closed)
+ * 	test     : processing of each solution found by the statistical test (the *_process_solution functions)
+ * 	output   : writing the significant patterns
+ * Each one measures the monotonic wall-clock time, the CPU time of the calling thread and, when the kernel allows it,
+ * the hardware counters cycles, instructions, cache misses (last level) and branch misses of the process in user
+ * space, read as a single perf_event_open group.
+ * Timers nest. Recursive calls of a running timer are not counted again, and each timer reports both its inclusive
+ * figures and its exclusive ones, which leave out the timers started inside it. The exclusive figures of all timers
+ * therefore partition the instrumented part of the run, and tell the mining apart from the test and the output.
+ * The results are written to the timing file and to the metrics document (metrics.c). Only meant for the main
+ * thread.
+ * */
+
+/* TIMER IDENTIFIERS */
+#define INSTR_LOAD 0
+#define INSTR_SHRINK 1
+#define INSTR_BM 2
+#define INSTR_ARY 3
+#define INSTR_VERTICAL 4
+#define INSTR_TEST 5
+#define INSTR_OUTPUT 6
+#define INSTR_N 7
+
+#ifdef INSTRUMENT
+#define INSTR_INIT() instr_init()
+#define INSTR_BEGIN(id) instr_begin(id)
+#define INSTR_END(id) instr_end(id)
+#else
+#define INSTR_INIT()
+#define INSTR_BEGIN(id)
+#define INSTR_END(id)
+#endif
+
+#ifdef INSTRUMENT
+/* CODE DEPENDENCIES */
+#include<time.h>
+#include<unistd.h>
+#include<sys/syscall.h>
+#include<linux/perf_event.h>
+
+/* FUNCTION DECLARATIONS */
+// Defined in metrics.c
+void metrics_object_begin(const char *name);
+void metrics_object_end();
+void metrics_int(const char *name, long long value);
+void metrics_double(const char *name, double value);
+
+/* CONSTANT DEFINES */
+#define INSTR_N_HW 4 //Number of hardware counters
+
+/* TYPES */
+// Values of all measures at a given time, or accumulated differences of them
+typedef struct {
+	double wall, cpu;
+	unsigned long long hw[INSTR_N_HW];
+} INSTR_SAMPLE;
+
+typedef struct {
+	int depth; // Number of running calls, only the outermost one is measured
+	unsigned long long calls;
+	INSTR_SAMPLE start, incl, excl;
+} INSTR_TIMER;
+
+/* GLOBAL VARIABLES */
+const char *instr_names[INSTR_N] = {"load","shrink","bm","ary","vertical","test","output"};
+const char *instr_hw_names[INSTR_N_HW] = {"cycles","instructions","llc_misses","branch_misses"};
+INSTR_TIMER instr_timers[INSTR_N];
+// Running timers, innermost last, and measures when the innermost one last started or resumed
+int instr_stack[INSTR_N], instr_top = 0;
+INSTR_SAMPLE instr_last;
+// Leader of the group of hardware counters, -1 if they are not available
+int instr_perf_fd = -1;
+
+/* INITIALISATION FUNCTIONS */
+
+/* Open the group of hardware counters. They are left unavailable if any of them cannot be opened */
+void instr_init(){
+	struct perf_event_attr attr;
+	unsigned long long configs[INSTR_N_HW] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+	int fds[INSTR_N_HW], i, j;
+
+	memset(instr_timers,0,sizeof(instr_timers));
+	for(i=0; i<INSTR_N_HW; i++){
+		memset(&attr,0,sizeof(struct perf_event_attr));
+		attr.size = sizeof(struct perf_event_attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = configs[i];
+		attr.read_format = PERF_FORMAT_GROUP;
+		attr.exclude_kernel = 1; attr.exclude_hv = 1;
+		fds[i] = syscall(__NR_perf_event_open,&attr,0,-1,i ? fds[0] : -1,0);
+		if(fds[i] < 0){
+			for(j=0; j<i; j++) close(fds[j]);
+			fprintf(stderr,"Warning in function instr_init: hardware counters not available\n");
+			return;
+		}
+	}
+	instr_perf_fd = fds[0];
+}
+
+/* CORE FUNCTIONS */
+
+void instr_sample(INSTR_SAMPLE *s){
+	struct timespec t;
+	struct { unsigned long long nr, values[INSTR_N_HW]; } group;
+	int i;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	s->wall = t.tv_sec + t.tv_nsec*1e-9;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID,&t);
+	s->cpu = t.tv_sec + t.tv_nsec*1e-9;
+	if((instr_perf_fd >= 0) && (read(instr_perf_fd,&group,sizeof(group)) == sizeof(group)))
+		for(i=0; i<INSTR_N_HW; i++) s->hw[i] = group.values[i];
+	else memset(s->hw,0,sizeof(s->hw));
+}
+
+// acc += to - from
+void instr_accumulate(INSTR_SAMPLE *acc, INSTR_SAMPLE *from, INSTR_SAMPLE *to){
+	int i;
+	acc->wall += to->wall - from->wall;
+	acc->cpu += to->cpu - from->cpu;
+	for(i=0; i<INSTR_N_HW; i++) acc->hw[i] += to->hw[i] - from->hw[i];
+}
+
+void instr_begin(int id){
+	INSTR_TIMER *t = instr_timers + id;
+	INSTR_SAMPLE s;
+	if(t->depth++) return;
+	instr_sample(&s);
+	// Pause the enclosing timer
+	if(instr_top) instr_accumulate(&instr_timers[instr_stack[instr_top-1]].excl,&instr_last,&s);
+	t->start = s; t->calls++;
+	instr_stack[instr_top++] = id;
+	instr_last = s;
+}
+
+void instr_end(int id){
+	INSTR_TIMER *t = instr_timers + id;
+	INSTR_SAMPLE s;
+	if(--t->depth) return;
+	instr_sample(&s);
+	instr_accumulate(&t->incl,&t->start,&s);
+	instr_accumulate(&t->excl,&instr_last,&s);
+	// Resume the enclosing timer
+	instr_top--;
+	instr_last = s;
+}
+
+/* OUTPUT FUNCTIONS */
+
+/* Write a table of all timers which were started at least once to f */
+void instr_report(FILE *f){
+	int id, i;
+	fprintf(f,"INSTRUMENTATION (inclusive / exclusive)\n");
+	for(id=0; id<INSTR_N; id++){
+		if(!instr_timers[id].calls) continue;
+		fprintf(f,"\t %s: %llu calls, wall %f / %f (s), cpu %f / %f (s)",instr_names[id],instr_timers[id].calls,
+				instr_timers[id].incl.wall,instr_timers[id].excl.wall,instr_timers[id].incl.cpu,instr_timers[id].excl.cpu);
+		if(instr_perf_fd >= 0)
+			for(i=0; i<INSTR_N_HW; i++)
+				fprintf(f,", %s %llu / %llu",instr_hw_names[i],instr_timers[id].incl.hw[i],instr_timers[id].excl.hw[i]);
+		fprintf(f,".\n");
+	}
+}
+
+void instr_metrics_sample(const char *name, INSTR_SAMPLE *s){
+	int i;
+	metrics_object_begin(name);
+	metrics_double("wall_s",s->wall);
+	metrics_double("cpu_s",s->cpu);
+	if(instr_perf_fd >= 0) for(i=0; i<INSTR_N_HW; i++) metrics_int(instr_hw_names[i],s->hw[i]);
+	metrics_object_end();
+}
+
+/* Write all timers which were started at least once to the metrics document */
+void instr_metrics(){
+	int id;
+	metrics_object_begin("instrumentation");
+	for(id=0; id<INSTR_N; id++){
+		if(!instr_timers[id].calls) continue;
+		metrics_object_begin(instr_names[id]);
+		metrics_int("calls",instr_timers[id].calls);
+		instr_metrics_sample("inclusive",&instr_timers[id].incl);
+		instr_metrics_sample("exclusive",&instr_timers[id].excl);
+		metrics_object_end();
+	}
+	metrics_object_end();
+}
+#endif
+
+#endif
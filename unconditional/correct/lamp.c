@@ -24,6 +24,7 @@ inline double min(double X , double Y){
 
 /* CONSTANT DEFINES */
 #define READ_BUF_SIZ 524288 //Size of the buffer to read chars from file
+#define WY_SEED 0 //Seed of the random number generator used to permute the class labels
 
 /* GLOBAL VARIABLES */
 FILE* results_file;
@@ -44,6 +45,8 @@ long long *freq_cnt;
 int sl1, sl2;
 // Current P-value threshold
 double delta;
+// Corrected significance threshold, computed by lamp_end
+double delta_corrected;
 // Flag variable to keep track of the last change done to region Sigma_k
 // If flag==1, the last change was sl1++ (shrink on extremes of the W)
 // If flag==0, the last change was sl2-- (shrink on center of the W)
@@ -57,15 +60,49 @@ double log_inv_binom_N_n;
 // Array with all values of minimum attainable P-value in [0,N] pre-computed
 double *psi;
 
+// State of the correction for one target FWER: testable region, P-value threshold and number of testable patterns
+typedef struct {
+	int sl1, sl2, flag;
+	double delta;
+	long long m_testable;
+} LAMP_STATE;
+// Multi-alpha mode: the target FWERs, given as a comma-separated list, sorted in increasing order. The last
+// (least stringent) one drives LCM through the global variables above, the others keep their state in
+// lamp_states and share the histogram freq_cnt
+int n_alphas;
+double *alphas;
+LAMP_STATE *lamp_states;
+
+// Number of permutations of the Westfall-Young mode, set by the optional argument -wy (0 = LAMP correction)
+int J = 0;
+// Minimum P-value found so far in each permutation
+double *min_pval;
+// Cell counts of the hypothesis being processed in each permutation
+int *perm_a;
+// Number of permutations with min_pval[j] <= delta, i.e. with a false positive at the current threshold
+int wy_false_positives;
+
 /* FUNCTION DECLARATIONS */
 void loggamma_init();
 void psi_init();
 int doublecomp(const void*,const void*);
 void get_N_n(char *);
+void read_labels_file(char *, char*);
+int wy_count_false_positives();
+int wy_rand_below(int);
+
+// Defined in out_of_core.c
+extern double ooc_mb;
+// Defined in vertical_bitset.c
+void VBS_perm_init(int);
+void VBS_perm_set(int, char *);
+void VBS_perm_counts(int *);
 
 // Profiling variables
 long long effective_total_dataset_frq;
 
+#include"budget.c"
+
 
 #include "unconditional.c"
 
@@ -77,7 +114,9 @@ long long effective_total_dataset_frq;
 void lamp_init(double target_fwer, char *labels_file , double epsilon_){
 	int j; //Loop variable
 
+	INSTR_BEGIN(INSTR_LOAD);
 	get_N_n(labels_file);
+	INSTR_END(INSTR_LOAD);
 	// Ensure class 1 is the minority class
 	if(n > (N/2)) n = N-n;
 
@@ -185,16 +224,16 @@ void psi_init(){
 
   /*for(x = 1; x < 10; x++){
     double pvalue_lowerbound , pvalue_upperbound;
-    unconditional_fast_test(x , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
+    unconditional_fast_test(x , min(x , n) , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
     fprintf(stderr,"psi[%d] = %e , %f\n",x,pvalue_lowerbound,pvalue_lowerbound);
   }*/
 
 	psi[0] = 1.0;
   psi[1] = 1.0;
   double pvalue_lowerbound , pvalue_upperbound;
-  unconditional_fast_test(2 , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
+  unconditional_fast_test(2 , min(2 , n) , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
   psi[2] = pvalue_lowerbound;
-  unconditional_fast_test(N-1 , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
+  unconditional_fast_test(N-1 , min(N-1 , n) , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
   psi[N-1] = pvalue_lowerbound;
   psi[N] = 1.0;
   /*fprintf(stderr,"psi[1] = %e\n",psi[1]);
@@ -205,18 +244,146 @@ void psi_init(){
 
 }
 
+/* Uniform random integer in [0,n), n <= RAND_MAX+1. Values of rand() above the largest multiple of n are
+ * rejected, so that every value is equally likely
+ * */
+int wy_rand_below(int n){
+	unsigned int range = ((unsigned int)RAND_MAX)+1, limit = range - (range % n);
+	unsigned int r;
+	do r = (unsigned int)rand(); while(r >= limit);
+	return r % n;
+}
+
+/* Initialise the Westfall-Young permutation mode: draw J random permutations of the class labels and hand them
+ * to the vertical bitset engine. Must be called after VBS_init
+ * */
+void wy_init(char *labels_file){
+	int i, j, k; //Loop variables
+	char *labels_buffer, *labels, aux;
+
+	// Allocate memory for the buffer containing the class labels, giving an error if it fails
+	labels_buffer = (char *)malloc(N*sizeof(char));
+	if(!labels_buffer){
+		fprintf(stderr,"Error in function wy_init: couldn't allocate memory for array labels_buffer\n");
+		exit(1);
+	}
+	// Vector of class labels, with labels of empty transactions removed
+	labels = (char *)malloc(root_trans_list.siz1*sizeof(char));
+	if(!labels){
+		fprintf(stderr,"Error in function wy_init: couldn't allocate memory for array labels\n");
+		exit(1);
+	}
+	INSTR_BEGIN(INSTR_LOAD);
+	read_labels_file(labels_file,labels_buffer);
+	INSTR_END(INSTR_LOAD);
+	// Ensure class 1 is the minority class, as lamp_init already did with n
+	for(i=0,k=0;i<N;i++) k += labels_buffer[i];
+	if(k != n) for(i=0;i<N;i++) labels_buffer[i] = !labels_buffer[i];
+	for(i=0;i<root_trans_list.siz1;i++) labels[i] = labels_buffer[non_empty_trans_idx[i]];
+	free(labels_buffer);
+
+	// Allocate memory for the minimum P-values and the cell counts of all permutations
+	min_pval = (double *)malloc(J*sizeof(double));
+	if(!min_pval){
+		fprintf(stderr,"Error in function wy_init: couldn't allocate memory for array min_pval\n");
+		exit(1);
+	}
+	for(j=0;j<J;j++) min_pval[j] = 1;
+	perm_a = (int *)malloc(J*sizeof(int));
+	if(!perm_a){
+		fprintf(stderr,"Error in function wy_init: couldn't allocate memory for array perm_a\n");
+		exit(1);
+	}
+	wy_false_positives = 0;
+
+	// Each permutation is a Fisher-Yates shuffle of the previous one
+	srand(WY_SEED);
+	VBS_perm_init(J);
+	for(j=0;j<J;j++){
+		for(i=root_trans_list.siz1-1;i>0;i--){
+			k = wy_rand_below(i+1);
+			aux = labels[i]; labels[i] = labels[k]; labels[k] = aux;
+		}
+		VBS_perm_set(j,labels);
+	}
+	free(labels);
+}
+
+/* Initialise the multi-alpha mode from the list of target FWERs (a single value disables it). Must be called
+ * after lamp_init
+ * */
+void multi_alpha_init(char *target_fwers){
+	int k; //Loop variable
+	char *s, *s_end;
+
+	n_alphas = 1;
+	for(s=target_fwers; *s; s++) if(*s == ',') n_alphas++;
+	alphas = (double *)malloc(n_alphas*sizeof(double));
+	if(!alphas){
+		fprintf(stderr,"Error in function multi_alpha_init: couldn't allocate memory for array alphas\n");
+		exit(1);
+	}
+	for(k=0,s=target_fwers; k<n_alphas; k++,s=s_end+1){
+		alphas[k] = strtod(s,&s_end);
+		if((s_end == s) || ((*s_end != ',') && (*s_end != '\0'))){
+			fprintf(stderr,"Error in function multi_alpha_init: invalid list of target FWERs %s\n",target_fwers);
+			exit(1);
+		}
+	}
+	qsort(alphas,n_alphas,sizeof(double),doublecomp);
+	alpha = alphas[n_alphas-1];
+
+	// All other target FWERs start from the same state as the driving one
+	lamp_states = (LAMP_STATE *)malloc(n_alphas*sizeof(LAMP_STATE));
+	if(!lamp_states){
+		fprintf(stderr,"Error in function multi_alpha_init: couldn't allocate memory for array lamp_states\n");
+		exit(1);
+	}
+	for(k=0; k<n_alphas-1; k++){
+		lamp_states[k].sl1 = sl1; lamp_states[k].sl2 = sl2; lamp_states[k].flag = flag;
+		lamp_states[k].delta = delta; lamp_states[k].m_testable = m_testable;
+	}
+}
+
 /* Free all allocated memory and give some output for debugging purposes */
 void lamp_end(){
-	int j, idx_max;
-	double delta_corrected;
+	int j, k, idx_max;
 	delta_corrected = alpha/m_testable;
-	// Print results
+	// A run stopped by its budget must also account for the testable patterns not found (budget.c)
+	if(budget_exhausted) delta_corrected = budget_threshold(alpha,delta,m_testable,LCM_th);
+	// In the Westfall-Young mode the corrected threshold is the largest value below which at most floor(alpha*J)
+	// permutations have their minimum P-value, i.e. the largest value strictly smaller than the
+	// (floor(alpha*J)+1)-th smallest minimum P-value. Minimum P-values above delta are not exact, since
+	// hypotheses which were never testable have not been evaluated, so the threshold is capped at delta
+	if(J){
+		qsort(min_pval,J,sizeof(double),doublecomp);
+		idx_max = (int)floor(alpha*J);
+		if(idx_max >= J) delta_corrected = min_pval[J-1];
+		else{
+			for(j=idx_max-1; (j >= 0) && (min_pval[j] == min_pval[idx_max]); j--);
+			delta_corrected = (j >= 0) ? min_pval[j] : 0;
+		}
+		if(delta_corrected > delta) delta_corrected = delta;
+	}
+	// Print results, one block per target FWER in the multi-alpha mode (the driving one being the last)
+	for(k=0; k<n_alphas-1; k++){
+		fprintf(results_file,"RESULTS\n");
+		fprintf(results_file,"\t Target FWER: %e\n",alphas[k]);
+		fprintf(results_file,"\t Corrected significance threshold: %e\n",budget_exhausted ? budget_threshold(alphas[k],lamp_states[k].delta,lamp_states[k].m_testable,lamp_states[k].sl1) : alphas[k]/lamp_states[k].m_testable);
+		fprintf(results_file,"\t Final LCM support: %d\n",lamp_states[k].sl1);
+		fprintf(results_file,"\t Testable region: [%d,%d] U [%d,%d]\n",lamp_states[k].sl1,lamp_states[k].sl2,N-lamp_states[k].sl2,N-lamp_states[k].sl1);
+		fprintf(results_file,"\t Final P-value lower bound: %e\n",lamp_states[k].delta);
+		fprintf(results_file,"\t Number of testable patterns at final P-value lower bound: %lld\n",lamp_states[k].m_testable);
+	}
 	fprintf(results_file,"RESULTS\n");
+	if(n_alphas > 1) fprintf(results_file,"\t Target FWER: %e\n",alpha);
+	if(J) fprintf(results_file,"\t Westfall-Young permutations: %d\n",J);
 	fprintf(results_file,"\t Corrected significance threshold: %e\n",delta_corrected);
 	fprintf(results_file,"\t Final LCM support: %d\n",LCM_th);
 	fprintf(results_file,"\t Testable region: [%d,%d] U [%d,%d]\n",sl1,sl2,N-sl2,N-sl1);
 	fprintf(results_file,"\t Final P-value lower bound: %e\n",delta);
 	fprintf(results_file,"\t Number of testable patterns at final P-value lower bound: %lld\n",m_testable);
+	if(budget_exhausted) budget_report(results_file);
 
 
 	fprintf(stderr,"Corrected significance threshold: %e\n",delta_corrected);
@@ -229,11 +396,65 @@ void lamp_end(){
 	free(loggamma);
 	free(psi);
 	free(freq_cnt);
+	free(alphas); free(lamp_states);
+	free(item_frq);
+	if(J){ free(min_pval); free(perm_a); }
 
 	// Close results file
 	fclose(results_file);
 }
 
+/* -------------------------------- METRICS (metrics.c) ----------------------------------------- */
+
+void metrics_config(){
+	metrics_int("N",N);
+	metrics_int("n",n);
+	metrics_double("target_fwer",alpha);
+	metrics_int("n_target_fwers",n_alphas);
+	metrics_double("time_budget_s",budget_time);
+	metrics_int("node_budget",budget_nodes);
+	metrics_int("workers",workers_n);
+	metrics_double("out_of_core_mb",ooc_mb);
+	metrics_string("trsact_order",trsact_order_names[trsact_order]);
+	metrics_string("shrink",shrink_names[shrink_mode]);
+	metrics_int("shrink_threads",shrink_threads);
+	cons_metrics();
+	metrics_double("epsilon",epsilon);
+	metrics_int("wy_permutations",J);
+}
+
+// Until lamp_end, the corrected significance threshold is not known yet and is reported as 0
+void metrics_counters(){
+	metrics_int("LCM_iters",LCM_iters);
+	metrics_int("effective_total_dataset_frq",effective_total_dataset_frq);
+	metrics_int("m_testable",m_testable);
+	metrics_int("LCM_th",LCM_th);
+	metrics_int("sl1",sl1);
+	metrics_int("sl2",sl2);
+	metrics_double("delta",delta);
+	metrics_double("corrected_significance_threshold",delta_corrected);
+	metrics_int("budget_exhausted",budget_exhausted);
+}
+
+/* -------------------------------- CHECKPOINTS (checkpoint.c) ----------------------------------------- */
+
+// State of the correction, and the results file which holds the values of psi printed so far
+void checkpoint_state(){
+	checkpoint_data(&sl1,sizeof(sl1)); checkpoint_data(&sl2,sizeof(sl2)); checkpoint_data(&flag,sizeof(flag));
+	checkpoint_data(&delta,sizeof(delta));
+	checkpoint_data(&m_testable,sizeof(m_testable));
+	checkpoint_data(freq_cnt,(N+1)*sizeof(long long));
+	// psi is only computed at the supports the correction has reached
+	checkpoint_data(psi,(N+1)*sizeof(double));
+	checkpoint_data(lamp_states,(n_alphas-1)*sizeof(LAMP_STATE));
+	checkpoint_data(&effective_total_dataset_frq,sizeof(effective_total_dataset_frq));
+	if(J){
+		checkpoint_data(min_pval,J*sizeof(double));
+		checkpoint_data(&wy_false_positives,sizeof(wy_false_positives));
+	}
+	checkpoint_output_file(results_file);
+}
+
 /* --------------------------------CORE FUNCTIONS------------------------------------ */
 
 /* Decrease the minimum p-value threshold one level
@@ -286,7 +507,7 @@ void decrease_threshold(){
 		sl1++; // Shrink Sigma_k on extremes of the W
 		// Check what the new case will be
     double pvalue_lowerbound , pvalue_upperbound;
-    unconditional_fast_test(sl1 , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
+    unconditional_fast_test(sl1 , min(sl1 , n) , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
     //psi[sl1] = computeUncondLBPValue_version3(sl1 , epsilon);
     psi[sl1] = pvalue_lowerbound;
     //fprintf(stderr,"psi[%d] = %e\n",sl1,psi[sl1]);
@@ -300,7 +521,7 @@ void decrease_threshold(){
 		sl2--; // Shrink Sigma_k on center of the W
 		// Check what the new case will be
     double pvalue_lowerbound , pvalue_upperbound;
-    unconditional_fast_test(sl2 , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
+    unconditional_fast_test(sl2 , min(sl2 , n) , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
     psi[sl2] = pvalue_lowerbound;
     //fprintf(stderr,"psi[%d] = %e\n",sl2,psi[sl2]);
     //computeUncondLBPValue_version3(sl2 , epsilon);
@@ -311,6 +532,105 @@ void decrease_threshold(){
 }
 
 
+/* Exchange the state of the correction held in the global variables with *s */
+void lamp_state_swap(LAMP_STATE *s){
+	LAMP_STATE aux;
+	aux.sl1 = sl1; aux.sl2 = sl2; aux.flag = flag; aux.delta = delta; aux.m_testable = m_testable;
+	sl1 = s->sl1; sl2 = s->sl2; flag = s->flag; delta = s->delta; m_testable = s->m_testable;
+	*s = aux;
+}
+
+/* Multi-alpha mode: process a hypothesis with margin x, already counted in freq_cnt, for all target FWERs
+ * except the driving one. Their thresholds are decreased with decrease_threshold() on a swapped-in state,
+ * leaving the support of LCM to the driving target FWER
+ * */
+void multi_alpha_process(int x){
+	int k; //Loop variable
+	int LCM_th_aux = LCM_th;
+	double alpha_aux = alpha;
+	for(k=0; k<n_alphas-1; k++){
+		lamp_state_swap(&lamp_states[k]); alpha = alphas[k];
+		// The W of the driving target FWER contains those of the others, whose high-support band can be wider
+		if((x <= N-sl1) && (psi[x] <= delta)){
+			m_testable++;
+			while((m_testable*delta) > alpha) decrease_threshold();
+		}
+		lamp_state_swap(&lamp_states[k]);
+	}
+	alpha = alpha_aux; LCM_th = LCM_th_aux;
+}
+
+/* -------------------------------- PARTITIONED MINING (workers.c) ----------------------------------------- */
+
+/* The processes share freq_cnt, followed by LCM_iters and effective_total_dataset_frq. Every WORKERS_SYNC_PERIOD
+ * testable patterns, a worker adds those it found to the shared histogram and takes the histogram of all processes
+ * as its own freq_cnt. This can only raise its LCM support, which it then does one step at a time as after any
+ * testable pattern, so histograms which are out of date are safe and the workers need no other synchronisation.
+ * Every closed itemset lies in the subtree of a single top-level item, and is counted by a single worker. At the
+ * end, the coordinator continues the correction from the merged histogram. The testable region only shrinks while
+ * m_testable*delta > alpha, which holds for the histogram of a worker only if it holds for the merged one, and all
+ * patterns in the final region have been counted, so the result is that of a run in a single process.
+ * */
+#define WORKERS_SYNC_PERIOD 4096 //Number of testable patterns found by a worker between two exchanges
+// Positions of LCM_iters and effective_total_dataset_frq in the shared counters, after freq_cnt
+#define WORKERS_ITERS (N+1)
+#define WORKERS_FRQ (N+2)
+
+// Number of testable patterns found by this process
+long long workers_found = 0;
+
+/* Number of patterns of the histogram freq_cnt in the current testable region */
+long long workers_region_count(){
+	long long m = 0;
+	int x;
+	for(x=sl1; x<=sl2; x++) m += freq_cnt[x];
+	//(beware of case sl2==N-sl2 since it could lead to counting the same thing twice!)
+	for(x=((N-sl2) > sl2) ? N-sl2 : sl2+1; x<=N-sl1; x++) m += freq_cnt[x];
+	return m;
+}
+
+/* Take the shared histogram as freq_cnt and bring the correction up to date with it. The thresholds of the other
+ * target FWERs of the multi-alpha mode are decreased here, the driving one by the caller
+ * */
+void workers_sync(){
+	int x, k; //Loop variables
+	int LCM_th_aux = LCM_th;
+	double alpha_aux = alpha;
+	workers_push();
+	for(x=0; x<=N; x++) freq_cnt[x] = workers_read(x);
+	for(k=0; k<n_alphas-1; k++){
+		lamp_state_swap(&lamp_states[k]); alpha = alphas[k];
+		m_testable = workers_region_count();
+		while((m_testable*delta) > alpha) decrease_threshold();
+		lamp_state_swap(&lamp_states[k]);
+	}
+	alpha = alpha_aux; LCM_th = LCM_th_aux;
+	m_testable = workers_region_count();
+}
+
+/* Count a testable pattern with margin x, already processed by this process */
+void workers_count(int x){
+	workers_delta[x]++; workers_delta[WORKERS_FRQ] += x;
+	if(!(++workers_found % WORKERS_SYNC_PERIOD) && (workers_id >= 0)) workers_sync();
+}
+
+/* Called by main after the mining. A worker hands its counts over and exits, the coordinator waits for all workers
+ * and finishes the correction with the merged histogram
+ * */
+void workers_end(){
+	if(workers_id >= 0){
+		// The root of the search is counted by the coordinator
+		workers_delta[WORKERS_ITERS] = LCM_iters - workers_iters_begin - 1;
+		workers_push();
+		workers_exit();
+	}
+	workers_wait();
+	LCM_iters += workers_read(WORKERS_ITERS);
+	effective_total_dataset_frq = workers_read(WORKERS_FRQ);
+	workers_sync();
+	while((m_testable*delta) > alpha) decrease_threshold();
+}
+
 /* -------------------FUNCTIONS TO PROCESS A NEWLY FOUND TESTABLE HYPOTHESIS-------------------------------------- */
 
 /* This code contains 3 difference functions to process newly found hypotheses. All of them are virtually identical
@@ -333,11 +653,14 @@ void decrease_threshold(){
 /* Process a solution involving the bitmap represented itemsets */
 // x = frequency (i.e. number of occurrences) of newly found solution
 void bm_process_solution(int x, int item, int *mask){
-	int i,j;//Loop iterators
+	int i;//Loop iterator
 
 	// Sanity-check
 	if (x != current_trans.siz) printf("Error: x = %d, current_trans.siz=%d\n",x,current_trans.siz);
 
+	// Margins in the untestable high-support band (N-sl1,N], beyond the W, are never testable. The supersets of the
+	// itemset are still explored, since their support can be lower
+	if(x > N-sl1) return;
 	// Minimum attainable P-value for the hypothesis
 	double psi_x = psi[x];
 	// Check if the newly found solution is in the current testable region Sigma_k
@@ -347,6 +670,8 @@ void bm_process_solution(int x, int item, int *mask){
 
 	// Process testable pattern by increasing counters
 	freq_cnt[x]++; m_testable++;
+	if(n_alphas > 1) multi_alpha_process(x);
+	if(workers_n > 1) workers_count(x);
 
 	/* Finally, check if the FWER upper bound constraint is still satisfied, if not decrease threshold */
 	while((m_testable*delta) > alpha) {
@@ -368,11 +693,12 @@ void bm_process_solution(int x, int item, int *mask){
 /* Process a solution involving the most frequent item (item 0) */
 // x = frequency (i.e. number of occurrences) of newly found solution
 void process_solution0(int x){
-	int i,j;//Loop iterators
-
 	// Sanity-check
 	if (x != bm_trans_list[1].siz) printf("Error: x = %d, bm_trans_list[1].siz=%d\n",x,bm_trans_list[1].siz);
 
+	// Margins in the untestable high-support band (N-sl1,N], beyond the W, are never testable. The supersets of the
+	// itemset are still explored, since their support can be lower
+	if(x > N-sl1) return;
 	// Minimum attainable P-value for the hypothesis
 	double psi_x = psi[x];
 	// Check if the newly found solution is in the current testable region Sigma_k
@@ -382,6 +708,8 @@ void process_solution0(int x){
 
 	// Process testable pattern by increasing counters
 	freq_cnt[x]++; m_testable++;
+	if(n_alphas > 1) multi_alpha_process(x);
+	if(workers_n > 1) workers_count(x);
 
 	/* Finally, check if the FWER constraint is still satisfied, if not decrease threshold */
 	while((m_testable*delta) > alpha) {
@@ -390,6 +718,65 @@ void process_solution0(int x){
 	}
 }
 
+/* Westfall-Young part of the processing of a testable hypothesis with margin x: update the minimum P-value of
+ * each permutation and decrease the threshold while the FWER estimated from the permutations exceeds alpha.
+ * As in FastWY, hypotheses which are not testable at the current threshold cannot change the corrected
+ * threshold and are never evaluated
+ * */
+void wy_process_solution(int x){
+	int j, a; //Loop iterator and cell count in permutation j
+	double pval, pvalue_upperbound; //P-value of the hypothesis in permutation j
+	double pi = (double)x / (double)N;
+	double pre_comp_xterms = (x*log(pi)) + ((N-x)*log(1.0 - pi));
+
+	// Cell counts in all permutations, from the tidset of the solution
+	VBS_perm_counts(perm_a);
+	for(j=0; j<J; j++){
+		a = perm_a[j];
+		// Unless the confidence intervals already decide the test, the P-value is at least the probability of the
+		// table itself at the nuisance parameter x/N. Only P-values below delta matter for the corrected threshold,
+		// so the full test is skipped when this single term already rules out an update
+		if(!check_bounds(x , a , epsilon , &pval , &pvalue_upperbound)){
+			pval = exp(pre_comp_xterms + logbincoeff(N-n,x-a) + logbincoeff(n,a));
+			if(pval > min(delta,min_pval[j])) continue;
+			unconditional_fast_test(x , a , epsilon , &pval , &pvalue_upperbound);
+		}
+		if(pval < min_pval[j]){
+			if((min_pval[j] > delta) && (pval <= delta)) wy_false_positives++;
+			min_pval[j] = pval;
+		}
+	}
+	while(wy_false_positives > alpha*J){
+		decrease_threshold();
+		wy_false_positives = wy_count_false_positives();
+	}
+}
+
+/* Process a solution found by the vertical bitset engine (vertical_bitset.c) */
+// x = frequency (i.e. number of occurrences) of newly found solution
+// a = cell count of newly found solution (not needed for the correction)
+void vbs_process_solution(int x, int a){
+	// Margins in the untestable high-support band (N-sl1,N], beyond the W, are never testable. The supersets of the
+	// itemset are still explored, since their support can be lower
+	if(x > N-sl1) return;
+	// Minimum attainable P-value for the hypothesis
+	double psi_x = psi[x];
+	// Check if the newly found solution is in the current testable region Sigma_k
+	if(psi_x > delta) return;
+
+	effective_total_dataset_frq += x; // Update profiling variable
+
+	// Process testable pattern by increasing counters
+	freq_cnt[x]++; m_testable++;
+	if(n_alphas > 1) multi_alpha_process(x);
+	if(workers_n > 1) workers_count(x);
+
+	/* Finally, check if the FWER constraint is still satisfied, if not decrease threshold */
+	// The vertical engine reads LCM_th before every extension, so no data structure needs fixing
+	if(J) wy_process_solution(x);
+	else while((m_testable*delta) > alpha) decrease_threshold();
+}
+
 /* Process a solution involving the array-list represented itemsets */
 // x = frequency (i.e. number of occurrences) of newly found solution
 // L = pointer to TRANS_LIST struct keeping track of merged transactions
@@ -401,6 +788,9 @@ void ary_process_solution(int x, TRANS_LIST *L, int item, int *mask){
 
 	/* First, process the new hypothesis */
 
+	// Margins in the untestable high-support band (N-sl1,N], beyond the W, are never testable. The supersets of the
+	// itemset are still explored, since their support can be lower
+	if(x > N-sl1) return;
 	// Minimum attainable P-value for the hypothesis
 	double psi_x = psi[x];
 	// Check if the newly found solution is in the current testable region Sigma_k
@@ -418,6 +808,8 @@ void ary_process_solution(int x, TRANS_LIST *L, int item, int *mask){
 
 	// Process testable pattern by increasing counters
 	freq_cnt[x]++; m_testable++;
+	if(n_alphas > 1) multi_alpha_process(x);
+	if(workers_n > 1) workers_count(x);
 
 	/* Finally, check if the FWER constraint is still satisfied, if not decrease threshold */
 	while((m_testable*delta) > alpha) {
@@ -444,6 +836,13 @@ int doublecomp(const void* elem1, const void* elem2){
     return *(const double*)elem1 > *(const double*)elem2;
 }
 
+// Number of permutations with a false positive at the current threshold delta
+int wy_count_false_positives(){
+	int j, false_positives = 0;
+	for(j=0; j<J; j++) if(min_pval[j] <= delta) false_positives++;
+	return false_positives;
+}
+
 /* Do a first scan of the file containing the class labels to compute the total number of observations, N,
  * and the total number of observations in the positive class, n
  * */
@@ -503,4 +902,57 @@ void get_N_n(char *labels_file){
 	free(read_buf);
 }
 
+void read_labels_file(char *labels_file, char *labels_buffer){
+	FILE *f_labels;//Stream with file containing class labels
+	int n_read;//Number of chars read
+	int i;// Iterator variable to be used in loops
+	char char_to_int[256];//Array for converting chars to int fast
+	char *read_buf, *read_buf_aux, *read_buf_end;//Buffer for reading from file and extra pointers for loops
+	char *labels_aux = labels_buffer;//Auxiliary pointer to array labels for increments
+
+	//Try to open file, giving an error message if it fails
+	if(!(f_labels = fopen(labels_file,"r"))){
+		fprintf(stderr, "Error in function read_labels_file when opening file %s\n",labels_file);
+		exit(1);
+	}
+
+	//Try to allocate memory for the buffer, giving an error message if it fails
+	read_buf = (char *)malloc(READ_BUF_SIZ*sizeof(char));
+	if(!read_buf){
+		fprintf(stderr,"Error in function read_labels_file: couldn't allocate memory for array read_buf\n");
+		exit(1);
+	}
+
+	//Initialize the char to int converter
+	for(i=0;i<256;i++) char_to_int[i] = 127;
+	// We only care about the chars '0' and '1'. Everything else is mapped into the same "bucket"
+	char_to_int['0'] = 0; char_to_int['1'] = 1;
+
+	// Read the entire file
+	while(1){
+		// Try to read READ_BUF_SIZ chars from the file containing the class labels
+		n_read = fread(read_buf,sizeof(char),READ_BUF_SIZ,f_labels);
+		// If the number of chars read, n_read_ is smaller than READ_BUF_SIZ, either the file ended
+		// or there was an error. Check if it was the latter
+		if((n_read < READ_BUF_SIZ) && !feof(f_labels)){
+			fprintf(stderr,"Error in function read_labels_file while reading the file %s\n",labels_file);
+			exit(1);
+		}
+		// Process the n_read chars read from the file
+		for(read_buf_aux=read_buf,read_buf_end=read_buf+n_read;read_buf_aux<read_buf_end;read_buf_aux++){
+			//If the character is anything other than '0' or '1' go to process the next char
+			if(char_to_int[*read_buf_aux] == 127) continue;
+			*labels_aux++ = char_to_int[*read_buf_aux];
+		}
+		// Check if the file ended,. If yes, then exit the while loop
+		if(feof(f_labels)) break;
+	}
+
+	//Close the file
+	fclose(f_labels);
+
+	//Free allocated memory
+	free(read_buf);
+}
+
 #endif
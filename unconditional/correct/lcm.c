@@ -9,6 +9,9 @@
 #include<time.h>
 #include"lib_e.c"
 #include"lcm_var.c"
+/* MODIFICATIONS FOR INSTRUMENTATION */
+#include"instrument.c"
+/* END OF MODIFICATIONS */
 #define LCM_PROBLEM LCM_CLOSED
 #include"trsact.c"
 #include"lcm_io.c"
@@ -27,6 +30,14 @@
 #include"time_keeping.c"
 /* END OF MODIFICATIONS */
 
+/* MODIFICATIONS FOR THE VERTICAL BITSET ENGINE */
+#include"vertical_bitset.c"
+/* END OF MODIFICATIONS */
+
+/* MODIFICATIONS FOR THE OUT-OF-CORE MODE */
+#include"out_of_core.c"
+/* END OF MODIFICATIONS */
+
 /* FUNCTION DECLARATIONS OF ORIGINAL LCM SOURCE */
 void LCMclosed_BM_iter(int item, int m, int pmask);
 
@@ -78,13 +89,29 @@ void LCMclosed_BM_iter(int item, int m, int pmask){
   LCM_additem(LCM_Op[item]);
   mask = LCM_BM_rm_infreq(item, &pmask);
 
+  /* MODIFICATIONS FOR ITEMSET CONSTRAINTS (constraints.c) */
+  // No itemset of the subtree is admissible: release the occurrences delivered to the items below, as the recursion does
+  if(cons_prune(cons_req_bm(item))){
+    for(ttt=0; ttt<item; ttt++) LCM_BM_occurrence_delete(ttt);
+    BM_CURRENT_TRANS_EMPTY();
+    while(LCM_itemsett>it) LCM_delitem();
+    BUF_clear(&LCM_B);
+    return;
+  }
+  /* END OF MODIFICATIONS */
+
   LCM_solution();
 
   /* MODIFICATION FOR FAST WY ALGORITHIM */
   if(LCM_frq != current_trans.siz){
 	  printf("LCM_frq=%d, current_trans.siz=%d\n",LCM_frq,current_trans.siz);
   }
-  bm_process_solution(LCM_frq,item,&mask);
+  // Only admissible itemsets are processed (constraints.c)
+  if(cons_admissible()){
+    INSTR_BEGIN(INSTR_TEST);
+    bm_process_solution(LCM_frq,item,&mask);
+    INSTR_END(INSTR_TEST);
+  }
   /* END OF MODIFICATION */
 
   /* MODIFICATION TO KEEP TRACK OF TRANSACTIONS */
@@ -107,7 +134,8 @@ void LCMclosed_BM_iter(int item, int m, int pmask){
 // LAST ARGUMENT ADDED FOR TRANSACTION KEEPING
 int LCMclosed_iter(ARY *T, int item, int prv, TRANS_LIST *trans_list){
   ARY TT;
-  int i, ii, e, ee, n, js=LCM_jump.s, it=LCM_itemsett, mask;
+  int i, ii, e, ee, js=LCM_jump.s, it=LCM_itemsett, mask;
+  COUNT_INT n;
   int flag=-1, perm[LCM_BM_MAXITEM], pmask = 0xffffffff;
   QUEUE_INT *q;
 
@@ -134,6 +162,11 @@ int LCMclosed_iter(ARY *T, int item, int prv, TRANS_LIST *trans_list){
     goto END2;
   }  /* itemset is not closed */
 
+  /* MODIFICATIONS FOR ITEMSET CONSTRAINTS (constraints.c) */
+  // No itemset of the subtree is admissible. The items below item can be added in it
+  if(cons_prune(cons_req_min < item)) goto END2;
+  /* END OF MODIFICATIONS */
+
   BUF_reset(&LCM_B);
   LCM_partition_prefix(item);
 
@@ -144,12 +177,19 @@ int LCMclosed_iter(ARY *T, int item, int prv, TRANS_LIST *trans_list){
     mask = LCM_BM_rm_infreq(LCM_BM_MAXITEM, &pmask);
     LCM_solution();
     /* MODIFICATIONS FOR WY ALGORITHM */
-    ary_process_solution(LCM_frq, trans_list, item, &mask);
+    // Only admissible itemsets are processed (constraints.c)
+    if(cons_admissible()){
+      INSTR_BEGIN(INSTR_TEST);
+      ary_process_solution(LCM_frq, trans_list, item, &mask);
+      INSTR_END(INSTR_TEST);
+    }
     /* END OF MODIFICATIONS */
     /* MODIFICATIONS FOR KEEPING TRACK OF TRANSACTIONS */
     //print_transaction_list(trans_list,item);
     /* END OF MODIFICATIONS */
+    INSTR_BEGIN(INSTR_BM);
     LCMclosed_BM_recursive(LCM_BM_MAXITEM, mask, pmask);
+    INSTR_END(INSTR_BM);
     BUF_clear(&LCM_B);
     goto END2;
   }
@@ -159,7 +199,12 @@ int LCMclosed_iter(ARY *T, int item, int prv, TRANS_LIST *trans_list){
   mask = LCM_BM_rm_infreq(LCM_BM_MAXITEM, &pmask);
   LCM_solution();
   /* MODIFICATIONS FOR WY ALGORITHM */
-  ary_process_solution(LCM_frq, trans_list, item, &mask);
+  // Only admissible itemsets are processed (constraints.c)
+  if(cons_admissible()){
+    INSTR_BEGIN(INSTR_TEST);
+    ary_process_solution(LCM_frq, trans_list, item, &mask);
+    INSTR_END(INSTR_TEST);
+  }
   /* END OF MODIFICATIONS */
   /* MODIFICATIONS FOR KEEPING TRACK OF TRANSACTIONS */
   //print_transaction_list(trans_list,item);
@@ -175,7 +220,9 @@ int LCMclosed_iter(ARY *T, int item, int prv, TRANS_LIST *trans_list){
   QUEUE_FE_LOOP_(LCM_jump, i, ii) LCM_Ofrq[ii] = LCM_th;
   LCM_Ofrq[item] = LCM_th;
   /* LAST TWO ARGUMENTS ADDED FOR TRANSACTION KEEPING */
+  INSTR_BEGIN(INSTR_SHRINK);
   LCM_mk_freq_trsact(&TT, T, item, LCM_Eend-1, n+(LCM_Ot[item]-LCM_Os[item]), mask, trans_list, &mk_trans_list);
+  INSTR_END(INSTR_SHRINK);
   /* END OF MODIFICATIONS */
   LCM_Ofrq[item] = 0;
 
@@ -183,7 +230,9 @@ int LCMclosed_iter(ARY *T, int item, int prv, TRANS_LIST *trans_list){
   for(i=0; i<LCM_BM_MAXITEM; i++) LCM_BM_occurrence_delete(i);
   LCMclosed_BM_occurrence_deliver_first(-1, &TT, &mk_trans_list);//LAST ARGUMENT ADDED FOR TRANSACTION KEEPING
   for(i=LCM_jump.s; i<LCM_jumpt; i++) LCM_Ofrq[LCM_jump.q[i]] = 0;
+  INSTR_BEGIN(INSTR_BM);
   LCMclosed_BM_recursive(LCM_BM_MAXITEM, 0xffffffff, 0xffffffff);
+  INSTR_END(INSTR_BM);
   BUF_clear(&LCM_B);
 
   if(QUEUE_LENGTH(LCM_jump) == 0) goto END0;
@@ -191,7 +240,9 @@ int LCMclosed_iter(ARY *T, int item, int prv, TRANS_LIST *trans_list){
   /* MODIFICATIONS FOR KEEPING TRACK OF TRANSACTIONS */
   if(ii >= 2 && TT.num>5){
 	  TRANS_LIST_INIT(&shrink_trans_list, mk_trans_list.siz1, mk_trans_list.siz2);
+	  INSTR_BEGIN(INSTR_SHRINK);
 	  LCM_shrink(&TT, item, 1, &mk_trans_list, &shrink_trans_list);//LAST TWO ARGUMENTS ADDED FOR TRANSACTION KEEPING
+	  INSTR_END(INSTR_SHRINK);
 	  TRANS_LIST_END(&mk_trans_list);
   }else{
 	  shrink_trans_list = mk_trans_list;
@@ -233,21 +284,44 @@ int LCMclosed_iter(ARY *T, int item, int prv, TRANS_LIST *trans_list){
 void LCMclosed(){
   int i;
   BUF_reset(&LCM_B);
+  progress_begin();
+  checkpoint_begin();
   LCMclosed_BM_occurrence_deliver_first(-1, &LCM_Trsact, &root_trans_list);//LAST ARGUMENT ADDED FOR TRANSACTION KEEPING
   for (i=LCM_BM_MAXITEM ; i<LCM_Eend ; i++){
     LCM_Ofrq_[i] = LCM_Ofrq[i];
     LCM_Ofrq[i] = 0;
   }
+  // Partitioned mining (workers.c): the subtree of an item is explored on the transactions containing it, with
+  // the items below it
+  if(workers_n > 1){
+    workers_cost[0] = ((double)LCM_Trsact.num)*LCM_BM_MAXITEM;
+    for(i=LCM_BM_MAXITEM ; i<LCM_Eend ; i++) workers_cost[i] = ((double)LCM_Ofrq_[i])*i;
+    workers_begin();
+  }
 
-  LCMclosed_BM_recursive(LCM_BM_MAXITEM, 0xffffffff, 0xffffffff);
+  // The bitmap phase is the top-level item 0 of the checkpoints (checkpoint.c) and of the partition (workers.c)
+  if(workers_item(0) && checkpoint_item(0)){
+    INSTR_BEGIN(INSTR_BM);
+    LCMclosed_BM_recursive(LCM_BM_MAXITEM, 0xffffffff, 0xffffffff);
+    INSTR_END(INSTR_BM);
+  }else{
+    // Explored by another worker or completed before the checkpoint: only release the occurrences of the bitmap items, as the bitmap phase does
+    for(i=0; i<LCM_BM_MAXITEM; i++) LCM_BM_occurrence_delete(i);
+  }
   BUF_clear(&LCM_B);
 
   for (i=LCM_BM_MAXITEM ; i<LCM_Eend ; i++){
-    LCMclosed_iter (&LCM_Trsact, i, -1, &root_trans_list);//LAST ARGUMENT ADDED FOR TRANSACTION KEEPING
+    if(workers_item(i) && checkpoint_item(i)){
+      progress_item = i;
+      INSTR_BEGIN(INSTR_ARY);
+      LCMclosed_iter (&LCM_Trsact, i, -1, &root_trans_list);//LAST ARGUMENT ADDED FOR TRANSACTION KEEPING
+      INSTR_END(INSTR_ARY);
+    }
     LCM_Ot[i] = LCM_Os[i];
     LCM_Ofrq_[i] = LCM_Ofrq[i] = 0;
   }
   LCM_iters++;
+  progress_end();
 }
 
 /*************************************************************************/
@@ -259,18 +333,75 @@ int main(int argc, char *argv[]){
 
   // Main input arguments which are not part of LCM
   double sig_th;
+  char *target_fwers;
   char *class_labels_file;
   char *tmp_filename;
 
   // Initial time
-  t_init = measureTime();
+  t_init = measureTime(); wt_init = measureWallTime();
+  INSTR_INIT();
 
   // Check if input contains all needed arguments
-  if (argc != 6){
-	  printf("LCM_LAMP_FISHER: output_basefilename target_fwer input_class_labels_file input_transactions_file epsilon\n");
+  if (argc < 6){
+	  printf("LCM_LAMP_FISHER: output_basefilename target_fwer[,target_fwer...] input_class_labels_file input_transactions_file epsilon [-vertical] [-out_of_core megabytes] [-wy n_permutations] [-trsact_order lex|gray|size] [-shrink sort|hash] [-shrink_threads k] [-max_len k] [-required_items i,j,...] [-excluded_items i,j,...] [-metrics_interval seconds] [-progress_interval seconds] [-checkpoint seconds] [-resume] [-workers k] [-time_budget seconds] [-node_budget iterations]\n");
 	  exit(1);
   }
 
+  // Optional arguments, given after the mandatory ones
+  for(i=6; i<argc; i++){
+	  if(!strcmp(argv[i],"-vertical")) use_vertical_engine = 1;
+	  // Vertical engine on projected databases spilled to disk (out_of_core.c)
+	  else if((i+1 < argc) && ooc_option(argv[i],argv[i+1])) i++;
+	  // Westfall-Young permutation mode, which needs the tidsets of the vertical engine
+	  else if(!strcmp(argv[i],"-wy") && (i+1 < argc)){
+		  J = atoi(argv[++i]);
+		  if(J <= 0){
+			  fprintf(stderr,"Error in function main: the number of permutations must be positive\n");
+			  exit(1);
+		  }
+		  use_vertical_engine = 1;
+	  }
+	  // Order of the transactions in memory (trsact_order.c)
+	  else if((i+1 < argc) && trsact_order_option(argv[i],argv[i+1])) i++;
+	  // Reduction of the conditional databases (shrink_hash.c)
+	  else if((i+1 < argc) && shrink_option(argv[i],argv[i+1])) i++;
+	  // Constraints on the itemsets tested (constraints.c)
+	  else if((i+1 < argc) && cons_option(argv[i],argv[i+1])) i++;
+	  // Interval between snapshots of the metrics (metrics.c)
+	  else if((i+1 < argc) && metrics_option(argv[i],argv[i+1])) i++;
+	  // Interval between progress reports (progress.c)
+	  else if((i+1 < argc) && progress_option(argv[i],argv[i+1])) i++;
+	  // Checkpoints, and resumption from the last one (checkpoint.c)
+	  else if((i+1 < argc) && checkpoint_option(argv[i],argv[i+1])) i++;
+	  else if(!strcmp(argv[i],"-resume")) checkpoint_resume = 1;
+	  // Partitioned mining over several processes (workers.c)
+	  else if((i+1 < argc) && workers_option(argv[i],argv[i+1])) i++;
+	  // Time and node budgets of the correction (budget.c)
+	  else if((i+1 < argc) && budget_option(argv[i],argv[i+1])) i++;
+	  else{
+		  fprintf(stderr,"Error in function main: unknown option %s\n",argv[i]);
+		  exit(1);
+	  }
+  }
+  if(J && (budget_time || budget_nodes)){
+	  fprintf(stderr,"Error in function main: the budgeted mode is not available in the Westfall-Young mode\n");
+	  exit(1);
+  }
+  if((workers_n > 1) && (J || budget_time || budget_nodes || checkpoint_interval || checkpoint_resume)){
+	  fprintf(stderr,"Error in function main: the partitioned mining is not available with -wy, budgets or checkpoints\n");
+	  exit(1);
+  }
+  if(ooc_mb && (J || (workers_n > 1) || checkpoint_interval || checkpoint_resume)){
+	  fprintf(stderr,"Error in function main: the out-of-core mode is not available with -wy, -workers or checkpoints\n");
+	  exit(1);
+  }
+
+  // Keep the command line for the metrics document (metrics.c)
+  metrics_init("unconditional_correct",argc,argv);
+  // Reports on SIGUSR1 and every progress_interval seconds (progress.c)
+  progress_init();
+  checkpoint_init();
+
   // Create output files for results and profiling
   tmp_filename = (char *)malloc((strlen(argv[1])+512)*sizeof(char));
   if(!tmp_filename){
@@ -285,7 +416,7 @@ int main(int argc, char *argv[]){
   }
   // Create a file to report results
   strcpy(tmp_filename,argv[1]); strcat(tmp_filename,"_results.txt");
-  if(!(results_file = fopen(tmp_filename,"w"))){
+  if(!(results_file = fopen(tmp_filename,CHECKPOINT_FOPEN_MODE))){
   	fprintf(stderr, "Error in function main when opening file %s\n",tmp_filename);
   	exit(1);
   }
@@ -295,6 +426,7 @@ int main(int argc, char *argv[]){
 
   // Additional arguments
   sig_th = atof(argv[2]);
+  target_fwers = argv[2];
   class_labels_file = argv[3];
   double epsilon = atof(argv[5]);
 
@@ -305,46 +437,74 @@ int main(int argc, char *argv[]){
   // Initialise the support of LCM to 1
   LCM_th = 1;
   /* END OF MODIFICATIONS */
-  tic = measureTime();
+  tic = measureTime(); wtic = measureWallTime();
   LCM_problem = LCM_CLOSED;
-  LCM_init(argc, argv);
+  INSTR_BEGIN(INSTR_LOAD);
+  if(ooc_mb) ooc_init(argv[1]);
+  else LCM_init(argc, argv);
+  // Items of the constraints in the numbering used by LCM (constraints.c)
+  cons_init();
+  INSTR_END(INSTR_LOAD);
   toc = measureTime();
-  time_LCM_init = toc-tic;
+  time_LCM_init = toc-tic; wall_LCM_init = measureWallTime()-wtic;
 
   //fprintf(stderr, "LCM_init done \n");
 
   /* MODIFICATIONS FOR FAST WY ALGORITHIM */
 
   // Initialize Westfall-Young permutation code
-  tic = measureTime();
+  tic = measureTime(); wtic = measureWallTime();
   lamp_init(sig_th,class_labels_file,epsilon);
+  multi_alpha_init(target_fwers);
+  if(J && (n_alphas > 1)){
+	  fprintf(stderr,"Error in function main: the Westfall-Young mode takes a single target FWER\n");
+	  exit(1);
+  }
+  if(workers_n > 1) workers_init(WORKERS_FRQ+1);
   toc = measureTime();
-  time_initialisation_lamp = toc-tic;
+  time_initialisation_lamp = toc-tic; wall_initialisation_lamp = measureWallTime()-wtic;
   /* END OF MODIFICATIONS */
-  tic = measureTime();
-  LCMclosed();
+  tic = measureTime(); wtic = measureWallTime();
+  if(ooc_mb){
+	  INSTR_BEGIN(INSTR_VERTICAL);
+	  ooc_closed();
+	  INSTR_END(INSTR_VERTICAL);
+  }else if(use_vertical_engine){
+	  VBS_init(NULL);
+	  if(J) wy_init(class_labels_file);
+	  INSTR_BEGIN(INSTR_VERTICAL);
+	  VBS_closed();
+	  INSTR_END(INSTR_VERTICAL);
+	  VBS_end();
+  }else LCMclosed();
+  // The workers exit here, and the coordinator merges their counts (workers.c)
+  if(workers_n > 1) workers_end();
   toc = measureTime();
-  time_threshold_correction = toc-tic;
+  time_threshold_correction = toc-tic; wall_threshold_correction = measureWallTime()-wtic;
 
   // Main part of the code
   LCM_output();
-  LCM_end();
-  ARY_end(&LCM_Trsact);
+  if(ooc_mb) ooc_end();
+  else{
+    LCM_end();
+    ARY_end(&LCM_Trsact);
+  }
 
   /* MODIFICATION TO KEEP TRACK OF TRANSACTIONS */
-  tic = measureTime();
-  transaction_keeping_end();
+  tic = measureTime(); wtic = measureWallTime();
+  if(!ooc_mb) transaction_keeping_end();
   /* END OF MODIFICATIONS */
   /* MODIFICATIONS FOR FAST WY ALGORITHIM */
   lamp_end();
   toc = measureTime();
-  time_termination = toc-tic;
+  time_termination = toc-tic; wall_termination = measureWallTime()-wtic;
   // Final time
-  t_end = measureTime();
+  t_end = measureTime(); wt_end = measureWallTime();
   /* END OF MODIFICATIONS */
 
   /* MODIFICATIONS FOR CODE PROFILING */
   profileCode();
+  metrics_end();
   /* END OF MODIFICATIONS */
 
   exit(0);
@@ -14,7 +14,8 @@
 /* Common initialization for LCM, LCMfreq, LCMmax */
 /*************************************************************************/
 int LCM_init(int argc, char *argv[]){
-  int i, m, n, nn, *bbuf;
+  int i, m, nn, *bbuf;
+  COUNT_INT n;
   QUEUE *Q;
   QUEUE_INT *x;
 
@@ -47,7 +48,7 @@ int LCM_init(int argc, char *argv[]){
   }
 
   if(LCM_print_flag & 2){
-    printf("shrinked database: #transactions=%d, #item=%d #elements=%d\n", LCM_Trsact.num, LCM_Eend, n );
+    printf("shrinked database: #transactions=%d, #item=%d #elements="COUNT_FMT"\n", LCM_Trsact.num, LCM_Eend, n );
   }
 
   bbuf = ((QUEUE *)(LCM_Trsact.h))->q;
@@ -75,10 +76,13 @@ int LCM_init(int argc, char *argv[]){
 //  TRSACT_sort_by_size ( &LCM_Trsact, &LCM_shrink_jump, LCM_shrink_p );
 //    realloc2 ( A->h, char, A->unit*A->end, "ARY_exp: A->h" );
 /***********************************************************************/
+  /* MODIFICATIONS FOR TRANSACTION REORDERING (trsact_order.c) */
+  TRSACT_reorder(&LCM_Trsact, &root_trans_list, bbuf);
+  /* END OF MODIFICATIONS */
 
   if(LCM_print_flag &2){
     for(n=i=0; i<LCM_Trsact.num; i++) n += ((QUEUE*)(LCM_Trsact.h))[i].t;
-    printf("shrinked database2: #transactions=%d, #item=%d #elements=%d\n", LCM_Trsact.num, LCM_Eend, n);
+    printf("shrinked database2: #transactions=%d, #item=%d #elements="COUNT_FMT"\n", LCM_Trsact.num, LCM_Eend, n);
     printf("LCM_BM_MAXITEM = %d\n", LCM_BM_MAXITEM );
   }
 
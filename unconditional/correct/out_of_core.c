@@ -0,0 +1,296 @@
+#ifndef _out_of_core_c_
+#define _out_of_core_c_
+
+/* OUT-OF-CORE MINING
+ * With the optional argument -out_of_core megabytes, the correction runs on the vertical bitset engine without ever
+ * holding the whole database in memory, which LCM_init and VBS_init both do. Instead
+ * 	- a first pass over the transactions file only counts the occurrences of each item (FASTI_count), and numbers
+ * 	  the frequent items as LCM_BM_load does,
+ * 	- the top-level items of the vertical engine are split into ranges of consecutive items, the partitions. The
+ * 	  subtree of an item is explored on its tidset, so a partition needs the transactions containing at least one
+ * 	  of its items, with all their items: its projected database. The ranges are as long as the tidsets of their
+ * 	  projected database (2*LCM_Eend+1 bitsets of as many bits as transactions, counting the stack of the search)
+ * 	  fit in the given number of megabytes, bounding the number of transactions by the sum of the supports of the
+ * 	  items of the range. A single item too frequent for the budget still makes a partition of its own,
+ * 	- the projected databases of up to OOC_MAX_OPEN partitions are written to binary spill files
+ * 	  <output_basefilename>_ooc_<partition>.bin in a single pass over the transactions file. Each transaction is
+ * 	  stored as its number of frequent items followed by the items, in the numbering of LCM,
+ * 	- the partitions are then mined one at a time, each one from the tidsets of its own transactions only, and their
+ * 	  spill files removed. The state of the correction simply carries over from one partition to the next.
+ * The closed itemsets of the subtree of an item are found from the transactions containing it alone, so the results
+ * are those of -vertical. The supports in VBS_frq are those of the whole database, as the engine only needs them as
+ * upper bounds on the supports within the current tidset, and they are exact for the top-level items.
+ * Memory then grows with the number of items and the largest projected database only, at the cost of writing the
+ * projected databases to disk, one transaction being written once per partition it meets, and of reading the
+ * transactions file once per OOC_MAX_OPEN partitions.
+ * Not available with -wy, -workers or checkpoints.
+ * */
+
+/* CONSTANT DEFINES */
+#define OOC_MAX_OPEN 128 //Maximum number of spill files written in a single pass over the transactions file
+
+/* GLOBAL VARIABLES */
+// Memory budget of the tidsets of a partition in megabytes, 0 if the mode is disabled
+double ooc_mb = 0;
+// Transactions file
+char *ooc_filename;
+// New number of each item of the file, -1 if it is infrequent, and number of items of the file
+int *ooc_map, ooc_map_len;
+// Number of partitions, first top-level item of each one (ooc_begin[ooc_n] = LCM_Eend), partition of each item and
+// number of transactions of each projected database
+int ooc_n;
+int *ooc_begin, *ooc_part, *ooc_ntrans;
+// Number of transactions with at least one frequent item
+int ooc_neff;
+// Items of the transaction being read, their number and the size of the array
+int *ooc_buf, ooc_buf_len, ooc_buf_siz;
+// Last transaction in which each item and each partition were seen, to skip duplicates
+int *ooc_item_mark, *ooc_part_mark;
+char *ooc_spill_filename;
+// Partitions whose spill files exist, those in [ooc_live_begin,ooc_live_end)
+int ooc_live_begin = 0, ooc_live_end = 0;
+
+/* FUNCTION DECLARATIONS */
+void ooc_spill_name(int p);
+void ooc_cleanup();
+
+/* INITIALISATION AND TERMINATION FUNCTIONS */
+
+/* Parse an optional argument -out_of_core value of main. Returns 1 if the argument was consumed */
+int ooc_option(char *arg, char *value){
+	if(strcmp(arg,"-out_of_core")) return 0;
+	ooc_mb = atof(value);
+	if(ooc_mb <= 0){
+		fprintf(stderr,"Error in function ooc_option: the memory budget must be positive\n");
+		exit(1);
+	}
+	use_vertical_engine = 1;
+	return 1;
+}
+
+/* Replaces LCM_init in the out-of-core mode: count the items, number the frequent ones and split them into
+ * partitions. Must be called after metrics_init
+ * */
+void ooc_init(char *filename){
+	ARY E;
+	COUNT_INT eles;
+	int i, m, *Eq;
+	double t_max, t_part;
+
+	ooc_filename = filename;
+	E = FASTI_count(filename, &LCM_trsact_num, &eles, &m);
+	Eq = E.h;
+	ooc_map_len = E.num;
+	FASTO_perm = TRSACT_sort_item_by_frq(&E, LCM_th, &eles, &LCM_Eend);
+	if(LCM_Eend == 0){
+		if(LCM_print_flag &2) printf("there is no frequent itemset\n");
+		exit(0);
+	}
+	// Support of all frequent items, for the bound of the budgeted mode (budget.c), and their new numbers
+	item_frq = (int *)malloc(LCM_Eend*sizeof(int));
+	if(!item_frq){
+		fprintf(stderr,"Error in function ooc_init: couldn't allocate memory for array item_frq\n");
+		exit(1);
+	}
+	for(i=0;i<LCM_Eend;i++) item_frq[i] = Eq[FASTO_perm[i]];
+	for(i=0;i<LCM_Eend;i++) Eq[FASTO_perm[i]] = i;
+	ooc_map = Eq;
+
+	// Counters of the solutions, as allocated by LCM_init
+	malloc2(LCM_sc, int, LCM_Eend+1, "ooc_init: LCM_sc");
+	for(i=0;i<=LCM_Eend;i++) LCM_sc[i] = 0;
+	VBS_items_init();
+
+	// Split the items into partitions, bounding the transactions of each one by the sum of the supports of its items
+	ooc_begin = (int *)malloc((LCM_Eend+1)*sizeof(int));
+	ooc_part = (int *)malloc(LCM_Eend*sizeof(int));
+	ooc_ntrans = (int *)calloc(LCM_Eend,sizeof(int));
+	if(!ooc_begin || !ooc_part || !ooc_ntrans){
+		fprintf(stderr,"Error in function ooc_init: couldn't allocate memory for array ooc_begin\n");
+		exit(1);
+	}
+	t_max = ooc_mb*1048576/((2.0*LCM_Eend+1)*sizeof(VBS_WORD))*VBS_WORD_BITS;
+	for(i=0, ooc_n=0, t_part=0; i<LCM_Eend; i++){
+		if(!i || (t_part+item_frq[i] > t_max)){
+			ooc_begin[ooc_n++] = i;
+			t_part = 0;
+		}
+		t_part += item_frq[i];
+		ooc_part[i] = ooc_n-1;
+	}
+	ooc_begin[ooc_n] = LCM_Eend;
+
+	ooc_buf_siz = 1024;
+	ooc_buf = (int *)malloc(ooc_buf_siz*sizeof(int));
+	ooc_item_mark = (int *)malloc(LCM_Eend*sizeof(int));
+	ooc_part_mark = (int *)malloc(ooc_n*sizeof(int));
+	ooc_spill_filename = (char *)malloc((strlen(metrics_basefilename)+512)*sizeof(char));
+	if(!ooc_buf || !ooc_item_mark || !ooc_part_mark || !ooc_spill_filename){
+		fprintf(stderr,"Error in function ooc_init: couldn't allocate memory for array ooc_buf\n");
+		exit(1);
+	}
+	atexit(ooc_cleanup);
+}
+
+/* Remove the spill files left when the run stops before all partitions have been mined (budget.c) */
+void ooc_cleanup(){
+	for(; ooc_live_begin<ooc_live_end; ooc_live_begin++){
+		ooc_spill_name(ooc_live_begin);
+		remove(ooc_spill_filename);
+	}
+}
+
+/* Replaces LCM_end, ARY_end(&LCM_Trsact) and transaction_keeping_end in the out-of-core mode */
+void ooc_end(){
+	VBS_end();
+	free(ooc_map); free(FASTO_perm);
+	free(ooc_begin); free(ooc_part); free(ooc_ntrans);
+	free(ooc_buf); free(ooc_item_mark); free(ooc_part_mark);
+	free(ooc_spill_filename);
+	free2(LCM_sc);
+}
+
+/* READ AND WRITE FUNCTIONS */
+
+/* Read the next transaction of f into ooc_buf, keeping its frequent items only, each once and with its new number.
+ * Returns 0 at the end of the file. Any character other than a digit separates two items, and '\n' two transactions
+ * */
+int ooc_read_transaction(FILE *f, int t){
+	int c, item, in_item = 0;
+
+	ooc_buf_len = 0;
+	item = 0;
+	while(1){
+		c = getc_unlocked(f);
+		if((c >= '0') && (c <= '9')){
+			item = item*10 + (c-'0');
+			in_item = 1;
+			continue;
+		}
+		if(in_item && (item < ooc_map_len) && (ooc_map[item] >= 0) && (ooc_item_mark[ooc_map[item]] != t)){
+			if(ooc_buf_len == ooc_buf_siz){
+				ooc_buf_siz *= 2;
+				realloc2(ooc_buf, int, ooc_buf_siz, "ooc_read_transaction: ooc_buf");
+			}
+			ooc_item_mark[ooc_map[item]] = t;
+			ooc_buf[ooc_buf_len++] = ooc_map[item];
+		}
+		in_item = 0; item = 0;
+		if(c == '\n') return 1;
+		if(c == EOF) return (ooc_buf_len > 0);
+	}
+}
+
+void ooc_spill_name(int p){
+	sprintf(ooc_spill_filename,"%s_ooc_%d.bin",metrics_basefilename,p);
+}
+
+/* Write the projected databases of the partitions in [p_begin,p_end) to their spill files, in a single pass over the
+ * transactions file. The first pass also computes the exact supports of the items and ooc_neff
+ * */
+void ooc_spill(int p_begin, int p_end){
+	FILE *f, *spill[OOC_MAX_OPEN];
+	int t, i, p;
+
+	if(!(f = fopen(ooc_filename,"r"))){
+		fprintf(stderr, "Error in function ooc_spill when opening file %s\n",ooc_filename);
+		exit(1);
+	}
+	for(p=p_begin; p<p_end; p++){
+		ooc_spill_name(p);
+		if(!(spill[p-p_begin] = fopen(ooc_spill_filename,"wb"))){
+			fprintf(stderr, "Error in function ooc_spill when opening file %s\n",ooc_spill_filename);
+			exit(1);
+		}
+		ooc_part_mark[p] = -1;
+	}
+	ooc_live_begin = p_begin; ooc_live_end = p_end;
+	for(i=0; i<LCM_Eend; i++) ooc_item_mark[i] = -1;
+
+	for(t=0; ooc_read_transaction(f,t); ){
+		if(!ooc_buf_len) continue;
+		if(!p_begin) for(i=0; i<ooc_buf_len; i++) VBS_frq[ooc_buf[i]]++;
+		for(i=0; i<ooc_buf_len; i++){
+			p = ooc_part[ooc_buf[i]];
+			if((p < p_begin) || (p >= p_end) || (ooc_part_mark[p] == t)) continue;
+			ooc_part_mark[p] = t;
+			ooc_ntrans[p]++;
+			if((fwrite(&ooc_buf_len,sizeof(int),1,spill[p-p_begin]) != 1) ||
+					(fwrite(ooc_buf,sizeof(int),ooc_buf_len,spill[p-p_begin]) != ooc_buf_len)){
+				fprintf(stderr,"Error in function ooc_spill: couldn't write to a spill file\n");
+				exit(1);
+			}
+		}
+		t++;
+	}
+	if(!p_begin) ooc_neff = t;
+
+	fclose(f);
+	for(p=p_begin; p<p_end; p++){
+		if(fclose(spill[p-p_begin])){
+			fprintf(stderr,"Error in function ooc_spill: couldn't write to a spill file\n");
+			exit(1);
+		}
+	}
+}
+
+/* Fill the tidsets with the projected database of partition p, and remove its spill file */
+void ooc_load(int p){
+	FILE *f;
+	int t, i, len;
+
+	VBS_words = CEIL(ooc_ntrans[p],VBS_WORD_BITS);
+	memset(VBS_tid,0,((size_t)LCM_Eend)*VBS_words*sizeof(VBS_WORD));
+	ooc_spill_name(p);
+	if(!(f = fopen(ooc_spill_filename,"rb"))){
+		fprintf(stderr, "Error in function ooc_load when opening file %s\n",ooc_spill_filename);
+		exit(1);
+	}
+	for(t=0; t<ooc_ntrans[p]; t++){
+		if((fread(&len,sizeof(int),1,f) != 1) || (fread(ooc_buf,sizeof(int),len,f) != len)){
+			fprintf(stderr,"Error in function ooc_load: truncated spill file %s\n",ooc_spill_filename);
+			exit(1);
+		}
+		for(i=0; i<len; i++) VBS_tid[ooc_buf[i]*VBS_words + t/VBS_WORD_BITS] |= 1ULL << (t%VBS_WORD_BITS);
+	}
+	fclose(f);
+	remove(ooc_spill_filename);
+	ooc_live_begin = p+1;
+}
+
+/* CORE FUNCTIONS */
+
+/* Replaces VBS_init and VBS_closed in the out-of-core mode */
+void ooc_closed(){
+	VBS_WORD *T;
+	int p, p_end, q, e, w, ntrans_max;
+
+	progress_begin();
+	for(p=0; p<ooc_n; p=p_end){
+		p_end = (p+OOC_MAX_OPEN < ooc_n) ? p+OOC_MAX_OPEN : ooc_n;
+		ooc_spill(p,p_end);
+		// As in VBS_closed, items contained in all transactions belong to every closed itemset
+		if(!p) for(e=0;e<LCM_Eend;e++) if(VBS_frq[e] == ooc_neff) VBS_additem(e);
+		for(q=p, ntrans_max=1; q<p_end; q++) if(ooc_ntrans[q] > ntrans_max) ntrans_max = ooc_ntrans[q];
+		VBS_tidsets_init(ntrans_max);
+
+		for(q=p; q<p_end; q++){
+			ooc_load(q);
+			if(!ooc_ntrans[q]) continue;
+			// The root of the partition is the set of all its transactions
+			T = VBS_stack;
+			for(w=0;w<VBS_words;w++) T[w] = ~0ULL;
+			if(ooc_ntrans[q] % VBS_WORD_BITS) T[VBS_words-1] = (1ULL << (ooc_ntrans[q] % VBS_WORD_BITS)) - 1;
+			VBS_top_begin = ooc_begin[q]; VBS_top_end = ooc_begin[q+1];
+			VBS_closed_iter(-1,0,0,VBS_words-1);
+		}
+		free(VBS_tid); free(VBS_stack);
+		VBS_tid = VBS_stack = ((VBS_WORD *)0);
+	}
+
+	while(VBS_itemst > 0) VBS_delitem();
+	LCM_iters++;
+	progress_end();
+}
+
+#endif
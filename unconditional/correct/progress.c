@@ -0,0 +1,148 @@
+#ifndef _progress_c_
+#define _progress_c_
+
+/* PROGRESS REPORTS
+ * A long run can be inspected without stopping it. On SIGUSR1 (kill -USR1 <pid>) and, with the optional argument
+ * -progress_interval seconds, every given number of seconds, the metrics document of the run so far (metrics.c) is
+ * written to <output_basefilename>_status.json, replacing the previous report. Besides the counters of the program
+ * (LCM_th, sl1, sl2, delta and m_testable for the correction), the document holds a "progress" object with
+ * 	- the top-level item being explored, out of LCM_Eend. Both engines take the items as roots of the search in
+ * 	  increasing order, and the bitmap phase of LCM counts as item 0,
+ * 	- the iterations of LCM (LCM_iters) per second since the start of the mining and since the previous report,
+ * 	- an estimate of the remaining time of the mining, extrapolating the time spent per top-level item so far. The
+ * 	  subtrees of the items differ widely in size, and the correction raises LCM_th as it goes, so the estimate only
+ * 	  tells minutes from days.
+ * As for the metrics snapshots, the signal and the timer thread only raise a flag, and the report is written by
+ * LCM_solution the next time a solution is found. It is written under a temporary name and then renamed, so the
+ * status file is never seen half-written.
+ * */
+
+/* CODE DEPENDENCIES */
+#include<pthread.h>
+#include<signal.h>
+
+/* GLOBAL VARIABLES */
+// Interval between reports in seconds, 0 if only SIGUSR1 triggers them
+double progress_interval = 0;
+// Set by SIGUSR1 or by the timer thread when a report is due
+volatile sig_atomic_t progress_due = 0;
+// Top-level item being explored, -1 before the mining starts and LCM_Eend after it ends
+int progress_item = -1;
+// Wall-clock time and LCM_iters at the start of the mining, at its end, and at the previous report
+double progress_start, progress_end_time, progress_last;
+int progress_iters_start, progress_iters_last;
+char *progress_filename, *progress_tmp_filename;
+pthread_t progress_thread;
+
+/* INITIALISATION FUNCTIONS */
+
+/* Parse an optional argument -progress_interval value of main. Returns 1 if the argument was consumed */
+int progress_option(char *arg, char *value){
+	if(strcmp(arg,"-progress_interval")) return 0;
+	progress_interval = atof(value);
+	if(progress_interval <= 0){
+		fprintf(stderr,"Error in function progress_option: the interval between reports must be positive\n");
+		exit(1);
+	}
+	return 1;
+}
+
+void progress_signal(int sig){
+	progress_due = 1;
+}
+
+void *progress_timer(void *arg){
+	struct timespec t;
+	t.tv_sec = (time_t)progress_interval;
+	t.tv_nsec = (long)((progress_interval - (time_t)progress_interval)*1e9);
+	while(1){
+		nanosleep(&t,NULL);
+		progress_due = 1;
+	}
+	return NULL;
+}
+
+/* Install the handler of SIGUSR1 and, if periodic reports were requested, start the timer thread. Must be called
+ * after metrics_init
+ * */
+void progress_init(){
+	struct sigaction sa;
+
+	progress_filename = (char *)malloc((strlen(metrics_basefilename)+512)*sizeof(char));
+	progress_tmp_filename = (char *)malloc((strlen(metrics_basefilename)+512)*sizeof(char));
+	if(!progress_filename || !progress_tmp_filename){
+		fprintf(stderr,"Error in function progress_init: couldn't allocate memory for array progress_filename\n");
+		exit(1);
+	}
+	strcpy(progress_filename,metrics_basefilename); strcat(progress_filename,"_status.json");
+	strcpy(progress_tmp_filename,metrics_basefilename); strcat(progress_tmp_filename,"_status.json.tmp");
+
+	// Interrupted system calls (such as the writes of the output files) are restarted
+	memset(&sa,0,sizeof(struct sigaction));
+	sa.sa_handler = progress_signal;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGUSR1,&sa,NULL);
+
+	if(progress_interval <= 0) return;
+	// The thread only sets a flag, and is not waited for at the end of the run
+	if(pthread_create(&progress_thread,NULL,progress_timer,NULL)){
+		fprintf(stderr,"Error in function progress_init: couldn't start the timer thread\n");
+		exit(1);
+	}
+	pthread_detach(progress_thread);
+}
+
+/* Called by LCMclosed and VBS_closed when the mining starts and when it ends */
+void progress_begin(){
+	progress_item = 0;
+	progress_start = progress_last = measureWallTime();
+	progress_iters_start = progress_iters_last = LCM_iters;
+}
+
+void progress_end(){
+	progress_item = LCM_Eend;
+	progress_end_time = measureWallTime();
+}
+
+/* OUTPUT FUNCTIONS */
+
+/* Write the "progress" object to the metrics document */
+void progress_metrics(){
+	double now, elapsed;
+
+	if(progress_item < 0) return;
+	now = (progress_item < LCM_Eend) ? measureWallTime() : progress_end_time;
+	elapsed = now - progress_start;
+	metrics_object_begin("progress");
+	metrics_int("item",progress_item);
+	metrics_int("LCM_Eend",LCM_Eend);
+	metrics_double("mining_wall_s",elapsed);
+	metrics_double("iters_per_s",(LCM_iters-progress_iters_start)/elapsed);
+	if(progress_item < LCM_Eend) metrics_double("recent_iters_per_s",(LCM_iters-progress_iters_last)/(now-progress_last));
+	// Unknown (null) until the first top-level item has been completed
+	if(progress_item < LCM_Eend) metrics_double("eta_s",progress_item ? elapsed*(LCM_Eend-progress_item)/progress_item : NAN);
+	else metrics_double("eta_s",0);
+	metrics_object_end();
+}
+
+/* Write a report, when progress_due has been set */
+void progress_write(){
+	FILE *f;
+
+	progress_due = 0;
+	if(!(f = fopen(progress_tmp_filename,"w"))){
+		fprintf(stderr, "Error in function progress_write when opening file %s\n",progress_tmp_filename);
+		exit(1);
+	}
+	metrics_write(f,0);
+	fclose(f);
+	if(rename(progress_tmp_filename,progress_filename)){
+		fprintf(stderr, "Error in function progress_write when renaming file %s\n",progress_tmp_filename);
+		exit(1);
+	}
+	progress_last = measureWallTime();
+	progress_iters_last = LCM_iters;
+}
+
+#endif
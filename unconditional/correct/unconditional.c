@@ -25,6 +25,8 @@ inline double logbincoeff(int n_, int k_){
 	return loggamma[n_] - loggamma[n_-k_] - loggamma[k_];
 }
 
+#include "bintail.c"
+
 
 int check_bounds(int x_s , int a_s , double epsilon , double *pvalue_lowerbound , double *pvalue_upperbound){
 
@@ -254,14 +256,14 @@ int check_bounds(int x_s , int a_s , double epsilon , double *pvalue_lowerbound
 					if(DEBUG_B){fprintf(stderr,"  FINISHED updating hint_a0 = %d , side = %d , p_table = %f , p0 = %f \n",*hint_a0,side,p_table,p0);}
 				}
 			// we need to compute the tail of binomial distribution of variables a0 and parameter pi
-			// we use the incomplete regularized beta function
-			// Pr(X >= a0) when X ~ Bin(n0 , pi)
+			// Pr(X >= a0) when X ~ Bin(n0 , pi) (bintail.c, formerly incbeta(a0,n0-a0+1,pi))
 			if(DEBUG_B){fprintf(stderr,"  min_a0 = %d , max_a0 = %d , a0 of tail = %d \n",min_a0,max_a0,a0);}
 			if(side > 0){
-				bin_tail = incbeta((double)a0, (double)(n0-a0+1), pi);
+				bin_tail = binomial_tail_upper(n0,a0,pi);
 			}
 			else{
-				bin_tail = incbeta((double)(n0-a0+1) , (double)(a0+1), 1.0-pi);
+				// same tail as incbeta(n0-a0+1,a0+1,1-pi)
+				bin_tail = binomial_tail_lower(n0+1,a0,pi);
 			}
 			//bin_tail = max(bin_tail , TINY);
 			//bin_tail = min(bin_tail , 1.0-TINY);
@@ -289,13 +291,11 @@ int check_bounds(int x_s , int a_s , double epsilon , double *pvalue_lowerbound
 
 
 
-		void unconditional_fast_test(int x_s , double epsilon , double *pvalue_lowerbound , double *pvalue_upperbound){
+		void unconditional_fast_test(int x_s , int a_s , double epsilon , double *pvalue_lowerbound , double *pvalue_upperbound){
 			int DEBUG_B = 0;
 			int DEBUG_L = 0;
 			int DEBUG_TAILS = 0;
 
-			int a_s = min(x_s , n);
-
 			if(DEBUG_B){
 				fprintf(stderr,"Starting new vesion of unconditional: (x_s = %d , a_s = %d , N = %d, n1 = %d)\n",x_s,a_s,N,n);
 			}
@@ -392,7 +392,7 @@ int check_bounds(int x_s , int a_s , double epsilon , double *pvalue_lowerbound
 				double right_tail_a1 = 0.0;
 				if(a1 >= 0 && a1 <=n1){
 					if(DEBUG_B){fprintf(stderr,"computing right tail with a1 %d \n",a1);}
-					right_tail_a1 = incbeta((double)a1, (double)(n1-a1+1), pi);
+					right_tail_a1 = binomial_tail_upper(n1,a1,pi);
 				}
 				// the same decreasing a1
 				a1 = (int)(((double)(n1+1) * pi) + 0.5)-1;
@@ -448,7 +448,7 @@ int check_bounds(int x_s , int a_s , double epsilon , double *pvalue_lowerbound
 				double left_tail_a1 = 0.0;
 				if(a1 >= 0 && a1 <=n1){
 					if(DEBUG_B){fprintf(stderr,"computing left tail with a1 %d \n",a1);}
-					left_tail_a1 = incbeta((double)(n1-a1+1) , (double)a1, 1.0-pi);
+					left_tail_a1 = binomial_tail_lower(n1,a1-1,pi);
 				}
 				p_value = exp(p_value) + right_tail_a1 + left_tail_a1;
 				if(DEBUG_B){fprintf(stderr,"FAST numtables = %d \n",numtables);}
@@ -0,0 +1,202 @@
+#ifndef _binary_output_c_
+#define _binary_output_c_
+
+/* BINARY OUTPUT OF THE SIGNIFICANT PATTERNS
+ * With the optional argument -binary_output, the significant itemsets and their p-values are written to a single
+ * binary file <output_basefilename>_sig_patterns.bin instead of the text files _sig_itemsets.txt and _sig_pvalues.txt,
+ * so that no number is formatted during the enumeration. binary_output_reader converts the file back to the two text
+ * files, identical to those written without the option. The layout of the file is described in binary_output.h.
+ * 	- LCM finds the itemsets in depth-first order, so consecutive itemsets share long prefixes. Each itemset record
+ * 	  only holds the length of the prefix shared with the previous itemset and the items after it.
+ * 	- Records are appended to one of two blocks of BINOUT_BLOCK_SIZE bytes, aligned to BINOUT_BLOCK_ALIGN bytes.
+ * 	  A full block is handed to a background writer thread, and the enumeration goes on filling the other one.
+ * 	  The file is unbuffered, so each block goes to the kernel with a single write.
+ * */
+
+/* CODE DEPENDENCIES */
+#include<pthread.h>
+#include"binary_output.h"
+
+/* FUNCTION DECLARATIONS */
+// Defined in checkpoint.c
+extern int checkpoint_resume, checkpoint_saving;
+void checkpoint_output_file(FILE *f);
+
+/* CONSTANT DEFINES */
+#ifndef BINOUT_BLOCK_SIZE
+#define BINOUT_BLOCK_SIZE 4194304 //Size of each block, in bytes
+#endif
+#define BINOUT_BLOCK_ALIGN 4096
+
+/* GLOBAL VARIABLES */
+// Set to 1 by the optional argument -binary_output
+int binary_output = 0;
+FILE *binout_file;
+// Blocks, block being filled and number of bytes already in it
+char *binout_block[2];
+int binout_cur;
+size_t binout_pos;
+// Block handed to the writer thread and its length, 1 in binout_busy until it has been written
+int binout_pending, binout_busy, binout_stop;
+size_t binout_pending_len;
+pthread_t binout_thread;
+pthread_mutex_t binout_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t binout_cond_work = PTHREAD_COND_INITIALIZER, binout_cond_done = PTHREAD_COND_INITIALIZER;
+// Items of the previous itemset record, and size of the array
+int32_t *binout_prev;
+int binout_prev_len, binout_prev_siz;
+
+/* WRITER THREAD */
+
+void *binout_writer(void *arg){
+	pthread_mutex_lock(&binout_mutex);
+	while(1){
+		while(!binout_busy && !binout_stop) pthread_cond_wait(&binout_cond_work,&binout_mutex);
+		if(!binout_busy) break;
+		pthread_mutex_unlock(&binout_mutex);
+		if(fwrite(binout_block[binout_pending],1,binout_pending_len,binout_file) != binout_pending_len){
+			fprintf(stderr,"Error in function binout_writer: couldn't write to the binary output file\n");
+			exit(1);
+		}
+		pthread_mutex_lock(&binout_mutex);
+		binout_busy = 0;
+		pthread_cond_signal(&binout_cond_done);
+	}
+	pthread_mutex_unlock(&binout_mutex);
+	return NULL;
+}
+
+/* Hand the block being filled to the writer thread, once it is done with the previous one */
+void binout_flush_block(){
+	pthread_mutex_lock(&binout_mutex);
+	while(binout_busy) pthread_cond_wait(&binout_cond_done,&binout_mutex);
+	binout_pending = binout_cur; binout_pending_len = binout_pos;
+	binout_busy = 1;
+	pthread_cond_signal(&binout_cond_work);
+	pthread_mutex_unlock(&binout_mutex);
+	binout_cur ^= 1; binout_pos = 0;
+}
+
+/* Append len bytes to the output */
+void binout_put(const void *src, size_t len){
+	size_t k;
+	while(len){
+		k = BINOUT_BLOCK_SIZE - binout_pos;
+		if(k > len) k = len;
+		memcpy(binout_block[binout_cur]+binout_pos,src,k);
+		binout_pos += k; src = (const char *)src + k; len -= k;
+		if(binout_pos == BINOUT_BLOCK_SIZE) binout_flush_block();
+	}
+}
+
+/* INITIALISATION AND TERMINATION FUNCTIONS */
+
+/* Create the file <output_basefilename>_sig_patterns.bin, write its header and start the writer thread.
+ * test = BINOUT_TEST_FISHER or BINOUT_TEST_UNCONDITIONAL
+ * */
+void binout_open(char *output_basefilename, int test, int N_, int n_){
+	char *tmp_filename;
+	BINOUT_HEADER header;
+	int i;
+
+	tmp_filename = (char *)malloc((strlen(output_basefilename)+512)*sizeof(char));
+	if(!tmp_filename){
+		fprintf(stderr,"Error in function binout_open: couldn't allocate memory for array tmp_filename\n");
+		exit(1);
+	}
+	strcpy(tmp_filename,output_basefilename); strcat(tmp_filename,"_sig_patterns.bin");
+	if(!(binout_file = fopen(tmp_filename,checkpoint_resume ? "r+b" : "wb"))){
+		fprintf(stderr, "Error in function binout_open when opening file %s\n",tmp_filename);
+		exit(1);
+	}
+	free(tmp_filename);
+	setvbuf(binout_file,NULL,_IONBF,0);
+	for(i=0; i<2; i++){
+		if(posix_memalign((void **)&binout_block[i],BINOUT_BLOCK_ALIGN,BINOUT_BLOCK_SIZE)){
+			fprintf(stderr,"Error in function binout_open: couldn't allocate memory for array binout_block\n");
+			exit(1);
+		}
+	}
+	binout_prev_siz = 64; binout_prev_len = 0;
+	binout_prev = (int32_t *)malloc(binout_prev_siz*sizeof(int32_t));
+	if(!binout_prev){
+		fprintf(stderr,"Error in function binout_open: couldn't allocate memory for array binout_prev\n");
+		exit(1);
+	}
+	binout_cur = 0; binout_pos = 0;
+	binout_busy = 0; binout_stop = 0;
+	if(pthread_create(&binout_thread,NULL,binout_writer,NULL)){
+		fprintf(stderr,"Error in function binout_open: couldn't start the writer thread\n");
+		exit(1);
+	}
+
+	memset(&header,0,sizeof(BINOUT_HEADER));
+	memcpy(header.magic,BINOUT_MAGIC,8);
+	header.test = test; header.N = N_; header.n = n_;
+	binout_put(&header,sizeof(BINOUT_HEADER));
+}
+
+/* Write the last block, stop the writer thread and close the file */
+void binout_close(){
+	if(binout_pos) binout_flush_block();
+	pthread_mutex_lock(&binout_mutex);
+	binout_stop = 1;
+	pthread_cond_signal(&binout_cond_work);
+	pthread_mutex_unlock(&binout_mutex);
+	pthread_join(binout_thread,NULL);
+	fclose(binout_file);
+	free(binout_block[0]); free(binout_block[1]);
+	free(binout_prev);
+}
+
+/* Save or restore the length of the file (checkpoint.c), all records so far being written first when saving.
+ * In both cases the next itemset record does not refer to the previous one, so that a resumed run writes the same
+ * bytes as an uninterrupted one. When resuming, the header written again by binout_open is dropped
+ * */
+void binout_checkpoint(){
+	if(checkpoint_saving){
+		if(binout_pos) binout_flush_block();
+		pthread_mutex_lock(&binout_mutex);
+		while(binout_busy) pthread_cond_wait(&binout_cond_done,&binout_mutex);
+		pthread_mutex_unlock(&binout_mutex);
+	}else binout_pos = 0;
+	binout_prev_len = 0;
+	checkpoint_output_file(binout_file);
+}
+
+/* CORE FUNCTIONS */
+
+/* Write the p-value record of a table with margin x and cell count a */
+void binout_pvalue(int x, int a, double p_lo, double p_hi){
+	BINOUT_PVALUE r;
+	r.tag = BINOUT_TAG_PVALUE; r.x = x; r.a = a; r.pad = 0;
+	r.p_lo = p_lo; r.p_hi = p_hi;
+	binout_put(&r,sizeof(BINOUT_PVALUE));
+}
+
+/* Write the itemset record of the len items of itemset (internal item ids, written as original ones) with support frq */
+void binout_itemset(int *itemset, int len, int frq){
+	BINOUT_ITEMSET r;
+	int32_t pad = 0;
+	int i;
+
+	if(len > binout_prev_siz){
+		while(len > binout_prev_siz) binout_prev_siz *= 2;
+		binout_prev = (int32_t *)realloc(binout_prev,binout_prev_siz*sizeof(int32_t));
+		if(!binout_prev){
+			fprintf(stderr,"Error in function binout_itemset: couldn't allocate memory for array binout_prev\n");
+			exit(1);
+		}
+	}
+	// Length of the prefix shared with the previous itemset, then store the items after it
+	for(i=0; (i<len) && (i<binout_prev_len) && (binout_prev[i] == FASTO_perm[itemset[i]]); i++);
+	r.prefix = i; r.n_new = len-i; r.frq = frq;
+	for(; i<len; i++) binout_prev[i] = FASTO_perm[itemset[i]];
+	binout_prev_len = len;
+
+	binout_put(&r,sizeof(BINOUT_ITEMSET));
+	binout_put(binout_prev+r.prefix,r.n_new*sizeof(int32_t));
+	if(!(r.n_new & 1)) binout_put(&pad,sizeof(int32_t));
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef _binary_output_h_
+#define _binary_output_h_
+
+/* Layout of the binary output file of the significant patterns, shared by binary_output.c and
+ * binary_output_reader.c. All fields are in the byte order of the machine which wrote the file.
+ * */
+
+/* CODE DEPENDENCIES */
+#include<stdint.h>
+
+/* CONSTANT DEFINES */
+#define BINOUT_MAGIC "SIGPAT01"
+#define BINOUT_TEST_FISHER 0
+#define BINOUT_TEST_UNCONDITIONAL 1
+#define BINOUT_TAG_PVALUE -1 // First field of a p-value record. Itemset records start with a prefix length >= 0
+
+/* TYPES */
+// File header
+typedef struct {
+	char magic[8]; // BINOUT_MAGIC, without the terminating null character
+	int32_t test; // BINOUT_TEST_FISHER or BINOUT_TEST_UNCONDITIONAL
+	int32_t N, n; // Number of observations and number of observations in the positive class
+	int32_t pad;
+} BINOUT_HEADER;
+
+// Cell count and p-value of a significant itemset. Fisher's exact test has p_lo = p_hi = p-value, the unconditional
+// test has p_lo and p_hi = lower and upper bounds on the p-value
+typedef struct {
+	int32_t tag; // BINOUT_TAG_PVALUE
+	int32_t x, a;
+	int32_t pad;
+	double p_lo, p_hi;
+} BINOUT_PVALUE;
+
+// Significant itemset, followed by its n_new last items and, if n_new is even, by one int32_t of padding, so that
+// every record has a length multiple of 8 bytes
+typedef struct {
+	int32_t prefix; // Number of first items shared with the previous itemset record
+	int32_t n_new; // Number of items after the shared prefix
+	int32_t frq; // Support of the itemset
+} BINOUT_ITEMSET;
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef _constraints_c_
+#define _constraints_c_
+
+/* ITEMSET CONSTRAINTS
+ * With the optional arguments
+ * 	-max_len k: itemsets of at most k items,
+ * 	-required_items i,j,...: itemsets containing at least one of the given items,
+ * 	-excluded_items i,j,...: itemsets containing none of the given items,
+ * with the items given by their identifiers in the transactions file, the hypothesis space is restricted to the
+ * closed itemsets satisfying all the constraints, the admissible ones. The other closed itemsets may still be visited
+ * by the engines, but are not processed as solutions: the correction does not count them as testable patterns
+ * (m_testable) and the enumeration does not test them. The threshold of the correction therefore controls the FWER
+ * over the admissible itemsets only, and the enumeration must be run with the same constraints.
+ * The constraints are checked on closed itemsets, so an itemset whose closure contains an excluded item is not
+ * admissible. The engines only add items to the itemsets of a subtree, hence the subtree of an itemset is pruned,
+ * before its database is projected, as soon as
+ * 	- the itemset has more than k items or contains an excluded item,
+ * 	- or the itemset contains no required item and none can be added in its subtree: LCM adds the items below the
+ * 	  one the subtree is rooted at, and the vertical engine those above it.
+ * */
+
+/* GLOBAL VARIABLES */
+// 1 if any constraint is set
+int cons_active = 0;
+// Maximum number of items of an itemset, 0 if not constrained
+int cons_max_len = 0;
+// Required and excluded items as given in the command line, NULL if there are none
+int *cons_req_list = NULL, *cons_exc_list = NULL;
+int cons_req_list_len = 0, cons_exc_list_len = 0;
+// Flags of the required and excluded items in the numbering used by LCM, and smallest and largest required item
+char *cons_req = NULL, *cons_exc = NULL;
+int cons_req_min, cons_req_max;
+// Items of the current itemset, and number of required and excluded items among them
+int *cons_stack;
+int cons_n_req = 0, cons_n_exc = 0;
+
+/* INITIALISATION FUNCTIONS */
+
+/* Parse a comma-separated list of items. Returns the list, and its length in len */
+int *cons_parse_items(char *value, int *len){
+	int *list, i, n;
+	char *p, *end;
+
+	for(p=value, n=1; *p; p++) if(*p == ',') n++;
+	list = (int *)malloc(n*sizeof(int));
+	if(!list){
+		fprintf(stderr,"Error in function cons_parse_items: couldn't allocate memory for array list\n");
+		exit(1);
+	}
+	for(p=value, i=0; i<n; i++, p=end+1){
+		list[i] = (int)strtol(p,&end,10);
+		if((end == p) || (list[i] < 0) || (*end && (*end != ','))){
+			fprintf(stderr,"Error in function cons_parse_items: invalid list of items %s\n",value);
+			exit(1);
+		}
+	}
+	*len = n;
+	return list;
+}
+
+/* Parse an optional argument -max_len, -required_items or -excluded_items of main. Returns 1 if the argument was
+ * consumed
+ * */
+int cons_option(char *arg, char *value){
+	if(!strcmp(arg,"-max_len")){
+		cons_max_len = atoi(value);
+		if(cons_max_len <= 0){
+			fprintf(stderr,"Error in function cons_option: the maximum itemset length must be positive\n");
+			exit(1);
+		}
+	}
+	else if(!strcmp(arg,"-required_items")) cons_req_list = cons_parse_items(value,&cons_req_list_len);
+	else if(!strcmp(arg,"-excluded_items")) cons_exc_list = cons_parse_items(value,&cons_exc_list_len);
+	else return 0;
+	cons_active = 1;
+	return 1;
+}
+
+// Orders items increasingly
+int cons_itemcomp(const void *elem1, const void *elem2){
+	return *(const int *)elem1 - *(const int *)elem2;
+}
+
+/* Flags of the items of list in the numbering used by LCM. Items which are not frequent are ignored */
+char *cons_flags(int *list, int len){
+	char *flags;
+	int e;
+
+	flags = (char *)calloc(LCM_Eend,sizeof(char));
+	if(!flags){
+		fprintf(stderr,"Error in function cons_flags: couldn't allocate memory for array flags\n");
+		exit(1);
+	}
+	qsort(list,len,sizeof(int),cons_itemcomp);
+	for(e=0; e<LCM_Eend; e++) flags[e] = (bsearch(FASTO_perm+e,list,len,sizeof(int),cons_itemcomp) != NULL);
+	return flags;
+}
+
+/* Translate the items of the constraints to the numbering used by LCM. Must be called after LCM_init */
+void cons_init(){
+	int e;
+
+	if(!cons_active) return;
+	// An itemset has at most LCM_Eend items
+	cons_stack = (int *)malloc((LCM_Eend+1)*sizeof(int));
+	if(!cons_stack){
+		fprintf(stderr,"Error in function cons_init: couldn't allocate memory for array cons_stack\n");
+		exit(1);
+	}
+	if(cons_req_list){
+		cons_req = cons_flags(cons_req_list,cons_req_list_len);
+		cons_req_min = LCM_Eend; cons_req_max = -1;
+		for(e=0; e<LCM_Eend; e++){
+			if(!cons_req[e]) continue;
+			if(e < cons_req_min) cons_req_min = e;
+			cons_req_max = e;
+		}
+	}
+	if(cons_exc_list) cons_exc = cons_flags(cons_exc_list,cons_exc_list_len);
+}
+
+/* CORE FUNCTIONS */
+
+/* Called by LCM_additem before item is added to the current itemset, and by LCM_delitem once the last item has
+ * been removed
+ * */
+void cons_additem(int item){
+	if(!cons_active) return;
+	cons_stack[LCM_itemsett] = item;
+	if(cons_req && cons_req[item]) cons_n_req++;
+	if(cons_exc && cons_exc[item]) cons_n_exc++;
+}
+
+void cons_delitem(){
+	int item;
+	if(!cons_active) return;
+	item = cons_stack[LCM_itemsett];
+	if(cons_req && cons_req[item]) cons_n_req--;
+	if(cons_exc && cons_exc[item]) cons_n_exc--;
+}
+
+/* Returns 1 if the current itemset and all itemsets of its subtree violate the length or exclusion constraints */
+int cons_dead(){
+	return (cons_max_len && (LCM_itemsett > cons_max_len)) || cons_n_exc;
+}
+
+/* Returns 1 if the current itemset is admissible, and must be processed as a solution */
+int cons_admissible(){
+	return !cons_active || (!cons_dead() && (!cons_req || cons_n_req));
+}
+
+/* Returns 1 if no itemset of the subtree of the current itemset, itself included, is admissible. req_reachable
+ * tells whether a required item can be added in the subtree
+ * */
+int cons_prune(int req_reachable){
+	return cons_active && (cons_dead() || (cons_req && !cons_n_req && !req_reachable));
+}
+
+/* Returns 1 if a required item can be added in the subtree of the bitmap item item of LCM, whose subtree adds the
+ * bitmap items below it
+ * */
+int cons_req_bm(int item){
+	int j;
+	if(!cons_req) return 0;
+	for(j=0; j<item; j++) if(cons_req[LCM_Op[j]]) return 1;
+	return 0;
+}
+
+/* OUTPUT FUNCTIONS */
+
+/* Write the "constraints" object to the metrics document */
+void cons_metrics(){
+	if(!cons_active) return;
+	metrics_object_begin("constraints");
+	metrics_int("max_len",cons_max_len);
+	metrics_int("n_required_items",cons_req_list_len);
+	metrics_int("n_excluded_items",cons_exc_list_len);
+	metrics_object_end();
+}
+
+#endif
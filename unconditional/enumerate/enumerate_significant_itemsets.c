@@ -21,6 +21,7 @@ inline double min(double X , double Y){
 #include"var_declare.h"
 #include"transaction_keeping.c"
 #include"lcm_var.c"
+#include"stat_tests.h"
 
 /* CONSTANT DEFINES */
 #define READ_BUF_SIZ 524288 //Size of the buffer to read chars from file
@@ -63,9 +64,15 @@ double *pvalues_cache;
 char *pvalues_cache_flag;
 int use_pvalues_cache;
 double *probabilities_thr;
+// Logarithms of the normalisation constants of the Chernoff bounds of the prefilter in check_bounds, cached for
+// each margin x and computed the first time x reaches the prefilter
+double *prefilter_logC;
+char *prefilter_logC_flag;
 
 long count_number_of_ci_rejects;
 long count_number_of_simpleub_rejects;
+long count_number_of_prefilter_rejects;
+long count_number_of_prefilter_nonrejects;
 long count_number_of_enumerate_rejects;
 long count_number_of_enumerate_nonrejects;
 long explored_patterns;
@@ -101,7 +108,9 @@ void enum_sig_itemsets_init(double sig_th, char *labels_file , int min_supp , do
 	int j; //Loop variable
 	char *labels_buffer;
 
+	INSTR_BEGIN(INSTR_LOAD);
 	get_N_n(labels_file);
+	INSTR_END(INSTR_LOAD);
 
 	// Store core constants
 	N_over_2 = (N % 2) ? (N-1)/2 : N/2;//floor(N/2)
@@ -124,6 +133,14 @@ void enum_sig_itemsets_init(double sig_th, char *labels_file , int min_supp , do
 		probabilities_thr[j] = 0.0;
 	}
 
+	// Allocate memory for the constants of the prefilter
+	prefilter_logC = (double *)malloc(((size_t)N)*PREFILTER_N_S*sizeof(double));
+	prefilter_logC_flag = (char *)calloc(N,sizeof(char));
+	if(!prefilter_logC || !prefilter_logC_flag){
+		fprintf(stderr,"Error in function enum_sig_itemsets_init: couldn't allocate memory for array prefilter_logC\n");
+		exit(1);
+	}
+
 	use_pvalues_cache = 1;
 	double order_of_magnitude = log(n+1) + log(N-n+1);
 	order_of_magnitude = order_of_magnitude / log(10.0);
@@ -133,8 +150,8 @@ void enum_sig_itemsets_init(double sig_th, char *labels_file , int min_supp , do
 		fprintf(stderr,"disabled p-values cache \n");
 	}
 	else{
-		size_of_T_tables = (n+1) * (N-n+1);
-		fprintf(stderr,"p-values cache on , size_of_T_tables %ld\n",size_of_T_tables);
+		size_of_T_tables = (unsigned long long)(n+1) * (N-n+1);
+		fprintf(stderr,"p-values cache on , size_of_T_tables %llu\n",size_of_T_tables);
 	}
 
 	if(use_pvalues_cache == 1){
@@ -171,7 +188,9 @@ void enum_sig_itemsets_init(double sig_th, char *labels_file , int min_supp , do
 
 	// Read file containing class labels and store them in array labels, taking care of removing labels
 	// associated with empty transactions
+	INSTR_BEGIN(INSTR_LOAD);
 	read_labels_file(labels_file,labels_buffer);
+	INSTR_END(INSTR_LOAD);
 	// Ensure class 1 is the minority class
 	if(n > (N/2)){
 		for(j=0; j<N; j++) labels_buffer[j] = !labels_buffer[j];
@@ -188,18 +207,27 @@ void enum_sig_itemsets_init(double sig_th, char *labels_file , int min_supp , do
 	free(labels_buffer);
 	// The array containing the indices of all non-empty transactions is no longer needed
 	free(non_empty_trans_idx);
+	// Cell counts are accumulated from the number of positives of each merged transaction
+	TRANS_LIST_COUNT_POSITIVES(&root_trans_list,labels);
 
 	// Initialise cache for log(x!) and psi(x)
 	loggamma_init();
 	psi_init();
 
+	// The testable region of the correction is contained in [min_supp,N-min_supp], the W being symmetric around N/2
 	testable_low = min_supp;
-	testable_high = N-1;
+	testable_high = N-min_supp;
+
+	#ifdef STAT_TESTS
+	stat_tests_init(sig_th);
+	#endif
 
 	// Initialise profiling variables
 	n_significant_patterns = 0;
 	count_number_of_ci_rejects = 0;
 	count_number_of_simpleub_rejects = 0;
+	count_number_of_prefilter_rejects = 0;
+	count_number_of_prefilter_nonrejects = 0;
 	count_number_of_enumerate_rejects = 0;
 	count_number_of_enumerate_nonrejects = 0;
 	explored_patterns = 0;
@@ -311,12 +339,17 @@ void enum_sig_itemsets_end(){
 	fprintf(results_file,"\t Corrected significance threshold: %e\n",delta);
 	fprintf(results_file,"\t LCM support: %d\n",LCM_th);
 	fprintf(results_file,"\t Number of significant patterns found: %lld\n",n_significant_patterns);
+	#ifdef STAT_TESTS
+	stat_tests_end();
+	#endif
 
 	fprintf(stderr, "Tested patterns %ld\n", explored_patterns);
 	fprintf(stderr, "explored_contingency_tables %ld\n", explored_contingency_tables);
 	fprintf(stderr, "Number of significant patterns found: %lld\n",n_significant_patterns);
 	fprintf(stderr, "count_number_of_ci_rejects %ld\n", count_number_of_ci_rejects);
 	fprintf(stderr, "count_number_of_simpleub_rejects %ld\n", count_number_of_simpleub_rejects);
+	fprintf(stderr, "count_number_of_prefilter_rejects %ld\n", count_number_of_prefilter_rejects);
+	fprintf(stderr, "count_number_of_prefilter_nonrejects %ld\n", count_number_of_prefilter_nonrejects);
 	fprintf(stderr, "count_number_of_enumerate_rejects %ld\n", count_number_of_enumerate_rejects);
 	fprintf(stderr, "count_number_of_enumerate_nonrejects %ld\n", count_number_of_enumerate_nonrejects);
 
@@ -326,11 +359,15 @@ void enum_sig_itemsets_end(){
 	free(Tvalues);
 	free(Tflag);
 	free(probabilities_cache);
+	free(prefilter_logC); free(prefilter_logC_flag);
 
 	// Close output files
 	fclose(results_file);
-	fclose(significant_itemsets_output_file);
-	fclose(pvalues_output_file);
+	if(binary_output) binout_close();
+	else{
+		fclose(significant_itemsets_output_file);
+		fclose(pvalues_output_file);
+	}
 
 }
 
@@ -375,6 +412,63 @@ double fisher_pval(int a, int x){
 	return 1;
 }
 
+// Additional tests evaluated in the same traversal
+#include"stat_tests.c"
+
+/* -------------------------------- METRICS (metrics.c) ----------------------------------------- */
+
+void metrics_config(){
+	metrics_int("N",N);
+	metrics_int("n",n);
+	metrics_double("corrected_significance_threshold",delta);
+	metrics_int("minimum_testable_support",LCM_th);
+	metrics_double("epsilon",epsilon);
+	metrics_string("trsact_order",trsact_order_names[trsact_order]);
+	metrics_string("shrink",shrink_names[shrink_mode]);
+	metrics_int("shrink_threads",shrink_threads);
+	cons_metrics();
+}
+
+void metrics_counters(){
+	metrics_int("LCM_iters",LCM_iters);
+	metrics_int("explored_patterns",explored_patterns);
+	metrics_int("explored_contingency_tables",explored_contingency_tables);
+	metrics_int("n_significant_patterns",n_significant_patterns);
+	metrics_int("count_number_of_ci_rejects",count_number_of_ci_rejects);
+	metrics_int("count_number_of_simpleub_rejects",count_number_of_simpleub_rejects);
+	metrics_int("count_number_of_prefilter_rejects",count_number_of_prefilter_rejects);
+	metrics_int("count_number_of_prefilter_nonrejects",count_number_of_prefilter_nonrejects);
+	metrics_int("count_number_of_enumerate_rejects",count_number_of_enumerate_rejects);
+	metrics_int("count_number_of_enumerate_nonrejects",count_number_of_enumerate_nonrejects);
+	#ifdef STAT_TESTS
+	#define STAT_TEST_METRICS(name) metrics_int(#name "_n_significant",name##_n_significant);
+	FOR_EACH_STAT_TEST(STAT_TEST_METRICS)
+	#endif
+}
+
+/* -------------------------------- CHECKPOINTS (checkpoint.c) ----------------------------------------- */
+
+// Counters, and lengths of the output files
+void checkpoint_state(){
+	checkpoint_data(&explored_patterns,sizeof(explored_patterns));
+	checkpoint_data(&n_significant_patterns,sizeof(n_significant_patterns));
+	checkpoint_data(&explored_contingency_tables,sizeof(explored_contingency_tables));
+	checkpoint_data(&count_number_of_ci_rejects,sizeof(count_number_of_ci_rejects));
+	checkpoint_data(&count_number_of_simpleub_rejects,sizeof(count_number_of_simpleub_rejects));
+	checkpoint_data(&count_number_of_prefilter_rejects,sizeof(count_number_of_prefilter_rejects));
+	checkpoint_data(&count_number_of_prefilter_nonrejects,sizeof(count_number_of_prefilter_nonrejects));
+	checkpoint_data(&count_number_of_enumerate_rejects,sizeof(count_number_of_enumerate_rejects));
+	checkpoint_data(&count_number_of_enumerate_nonrejects,sizeof(count_number_of_enumerate_nonrejects));
+	if(binary_output) binout_checkpoint();
+	else{
+		checkpoint_output_file(significant_itemsets_output_file);
+		checkpoint_output_file(pvalues_output_file);
+	}
+	#ifdef STAT_TESTS
+	stat_tests_checkpoint();
+	#endif
+}
+
 /* -------------------FUNCTIONS TO PROCESS A NEWLY FOUND TESTABLE HYPOTHESIS-------------------------------------- */
 
 /* This code contains 3 difference functions to process newly found hypotheses. All of them are virtually identical
@@ -397,21 +491,27 @@ double fisher_pval(int a, int x){
 /* Process a solution involving the bitmap represented itemsets */
 // x = frequency (i.e. number of occurrences) of newly found solution
 void bm_process_solution(int x, int item, int *mask){
-	int i,j;//Loop iterators
 	int a; //Cell count of current itemset
 	double pvalue_lowerbound , pvalue_upperbound;//P-value of current itemset
 
 	// Sanity-check
 	if (x != current_trans.siz) printf("Error: x = %d, current_trans.siz=%d\n",x,current_trans.siz);
 
+	// Compute the cell-count corresponding to the current itemset
+	a = current_trans.pos;
+	#ifdef STAT_TESTS
+	// The additional tests run on every hypothesis visited by the traversal, before the filter of the main test
+	stat_tests_process(x,a);
+	#endif
+
+	// Margins in the untestable high-support band (testable_high,N] are never testable: no test is run and nothing
+	// is written. The supersets of the itemset are still explored, since their support can be lower
+	if(x > testable_high) return;
 	// Minimum attainable P-value for the hypothesis
 	double psi_x = psi[x];
 	// Check if the newly found solution is in the current testable region Sigma_k
 	if(psi_x > delta) return;
 
-	// Compute the cell-count corresponding to the current itemset
-	a = 0;
-	for(i=0; i<current_trans.siz; i++) a += labels[current_trans.list[i]];
 	// Compute the corresponding p-value
 	//pval = computeUncondUBPValue(x , a);//computePvalueBarnard(x , a , 1.0); //fisher_pval(a,x);
 	#ifdef VERSION2
@@ -444,8 +544,11 @@ void bm_process_solution(int x, int item, int *mask){
 	if(pvalue_lowerbound <= delta){
 		//printf("pval = %f\n",pval);
 		n_significant_patterns++;
-		fprintf(pvalues_output_file,"%d,%d,%d,%e,%e,%e\n",a,x-a,x,computeP0(x , a),pvalue_lowerbound,pvalue_upperbound);
+		INSTR_BEGIN(INSTR_OUTPUT);
+		if(binary_output) binout_pvalue(x,a,pvalue_lowerbound,pvalue_upperbound);
+		else fprintf(pvalues_output_file,"%d,%d,%d,%e,%e,%e\n",a,x-a,x,computeP0(x , a),pvalue_lowerbound,pvalue_upperbound);
 		fprintf_current_itemset();
+		INSTR_END(INSTR_OUTPUT);
 	}
 
 
@@ -454,21 +557,27 @@ void bm_process_solution(int x, int item, int *mask){
 /* Process a solution involving the most frequent item (item 0) */
 // x = frequency (i.e. number of occurrences) of newly found solution
 void process_solution0(int x){
-	int i,j;//Loop iterators
 	int a; //Cell count of current itemset
 	double pvalue_lowerbound , pvalue_upperbound;//P-value of current itemset
 
 	// Sanity-check
 	if (x != bm_trans_list[1].siz) printf("Error: x = %d, bm_trans_list[1].siz=%d\n",x,bm_trans_list[1].siz);
 
+	// Compute the cell-count corresponding to the current itemset
+	a = bm_trans_list[1].pos;
+	#ifdef STAT_TESTS
+	// The additional tests run on every hypothesis visited by the traversal, before the filter of the main test
+	stat_tests_process(x,a);
+	#endif
+
+	// Margins in the untestable high-support band (testable_high,N] are never testable: no test is run and nothing
+	// is written. The supersets of the itemset are still explored, since their support can be lower
+	if(x > testable_high) return;
 	// Minimum attainable P-value for the hypothesis
 	double psi_x = psi[x];
 	// Check if the newly found solution is in the current testable region Sigma_k
 	if(psi_x > delta) return;
 
-	// Compute the cell-count corresponding to the current itemset
-	a = 0;
-	for(i=0; i<bm_trans_list[1].siz; i++) a += labels[bm_trans_list[1].list[i]];
 	// Compute the corresponding p-value
 	//pval = computeUncondUBPValue(x , a);//computePvalueBarnard(x , a , 1.0); //fisher_pval(a,x);
 	#ifdef VERSION2
@@ -503,8 +612,56 @@ void process_solution0(int x){
 	if(pvalue_lowerbound <= delta){
 		//printf("pval = %f\n",pval);
 		n_significant_patterns++;
-		fprintf(pvalues_output_file,"%d,%d,%d,%e,%e,%e\n",a,x-a,x,computeP0(x , a),pvalue_lowerbound,pvalue_upperbound);
+		INSTR_BEGIN(INSTR_OUTPUT);
+		if(binary_output) binout_pvalue(x,a,pvalue_lowerbound,pvalue_upperbound);
+		else fprintf(pvalues_output_file,"%d,%d,%d,%e,%e,%e\n",a,x-a,x,computeP0(x , a),pvalue_lowerbound,pvalue_upperbound);
 		LCMFREQ_output_itemset(LCM_add.q+LCM_add.t);
+		INSTR_END(INSTR_OUTPUT);
+	}
+}
+
+/* Process a solution found by the vertical bitset engine (vertical_bitset.c) */
+// x = frequency (i.e. number of occurrences) of newly found solution
+// a = cell count of newly found solution, already computed by the engine
+void vbs_process_solution(int x, int a){
+	double pvalue_lowerbound , pvalue_upperbound;//P-value of current itemset
+
+	#ifdef STAT_TESTS
+	// The additional tests run on every hypothesis visited by the traversal, before the filter of the main test
+	stat_tests_process(x,a);
+	#endif
+
+	// Margins in the untestable high-support band (testable_high,N] are never testable: no test is run and nothing
+	// is written. The supersets of the itemset are still explored, since their support can be lower
+	if(x > testable_high) return;
+	// Minimum attainable P-value for the hypothesis
+	double psi_x = psi[x];
+	// Check if the newly found solution is in the current testable region Sigma_k
+	if(psi_x > delta) return;
+
+	// Compute the corresponding p-value
+	#ifdef VERSION2
+	pvalue_lowerbound = computeUncondUBPValue_version2(x , a , epsilon);
+	pvalue_upperbound = 1.0;
+	#endif
+	#ifdef VERSION3
+	computeUncondUBPValue_version3(x , a , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
+	#endif
+	#ifdef VERSIONNAIVE
+	compute_naive_ut(x , a , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
+	#endif
+	#ifdef VERSION4
+	unconditional_fast_test(x , a , epsilon , &pvalue_lowerbound , &pvalue_upperbound);
+	#endif
+
+	// If p-value is significant, write current itemset and the corresponding p-value to the output files
+	if(pvalue_lowerbound <= delta){
+		n_significant_patterns++;
+		INSTR_BEGIN(INSTR_OUTPUT);
+		if(binary_output) binout_pvalue(x,a,pvalue_lowerbound,pvalue_upperbound);
+		else fprintf(pvalues_output_file,"%d,%d,%d,%e,%e,%e\n",a,x-a,x,computeP0(x , a),pvalue_lowerbound,pvalue_upperbound);
+		fprintf_current_itemset();
+		INSTR_END(INSTR_OUTPUT);
 	}
 }
 
@@ -513,29 +670,43 @@ void process_solution0(int x){
 // L = pointer to TRANS_LIST struct keeping track of merged transactions
 // item = current node of the tree
 void ary_process_solution(int x, TRANS_LIST *L, int item, int *mask){
-	int j;//Loop iterator
-	int aux; //Auxiliary counter
-	int *t, *t_end, *ptr, *end_ptr; //Pointers for iterating on transaction list
+	int *t, *t_end; //Pointers for iterating on transaction list
 	int a; //Cell count of current itemset
 	double pvalue_lowerbound , pvalue_upperbound;//P-value of current itemset
 
 	/* First, process the new hypothesis */
 
-	// Minimum attainable P-value for the hypothesis
-	double psi_x = psi[x];
-	// Check if the newly found solution is in the current testable region Sigma_k
-	if(psi_x > delta) return;
-
-	// Compute the cell-count corresponding to the current itemset, plus sanity-check
-	a = 0; aux = 0;
+	// Compute the cell-count corresponding to the current itemset as a sum over merged transactions
+	a = 0;
+	for(t=LCM_Os[item],t_end=LCM_Ot[item];t<t_end;t++) a += L->pos[*t];
+	#ifdef DEBUG_TRANSACTION_KEEPING
+	// Sanity-check against the original transactions
+	int aux; //Auxiliary counter
+	int *ptr, *end_ptr; //Pointers for iterating on the original transactions of a merged transaction
+	int a_check = 0; aux = 0;
 	for(t=LCM_Os[item],t_end=LCM_Ot[item];t<t_end;t++){
 		end_ptr = (*t == (L->siz2-1)) ? L->list + L->siz1 : L->ptr[*t+1];
 		for(ptr = L->ptr[*t];ptr < end_ptr;ptr++){
-			a += labels[*ptr];
+			a_check += labels[*ptr];
 			aux++;
 		}
 	}
 	if (x != aux) printf("Error: x = %d, trans_size=%d\n",x,aux);
+	if (a != a_check) printf("Error: a = %d, positives in trans list=%d\n",a,a_check);
+	#endif
+	#ifdef STAT_TESTS
+	// The additional tests run on every hypothesis visited by the traversal, before the filter of the main test
+	stat_tests_process(x,a);
+	#endif
+
+	// Margins in the untestable high-support band (testable_high,N] are never testable: no test is run and nothing
+	// is written. The supersets of the itemset are still explored, since their support can be lower
+	if(x > testable_high) return;
+	// Minimum attainable P-value for the hypothesis
+	double psi_x = psi[x];
+	// Check if the newly found solution is in the current testable region Sigma_k
+	if(psi_x > delta) return;
+
 	// Compute the corresponding p-value
 	//pval = computeUncondUBPValue(x , a);//computePvalueBarnard(x , a , 1.0); //fisher_pval(a,x);
 	//pval = computeUncondUBPValue_version2(x , a , epsilon);
@@ -571,8 +742,11 @@ void ary_process_solution(int x, TRANS_LIST *L, int item, int *mask){
 	if(pvalue_lowerbound <= delta){
 		//printf("pval = %f\n",pval);
 		n_significant_patterns++;
-		fprintf(pvalues_output_file,"%d,%d,%d,%e,%e,%e\n",a,x-a,x,computeP0(x , a),pvalue_lowerbound,pvalue_upperbound);
+		INSTR_BEGIN(INSTR_OUTPUT);
+		if(binary_output) binout_pvalue(x,a,pvalue_lowerbound,pvalue_upperbound);
+		else fprintf(pvalues_output_file,"%d,%d,%d,%e,%e,%e\n",a,x-a,x,computeP0(x , a),pvalue_lowerbound,pvalue_upperbound);
 		fprintf_current_itemset();
+		INSTR_END(INSTR_OUTPUT);
 	}
 
 }
@@ -13,8 +13,8 @@
 #define MAX(a,b)      ((a)>(b)?a:b)
 #define MIN(a,b)      ((a)<(b)?a:b)
 
-#define   malloc2(f,a,b,c)     if(!(f=(a *)malloc(sizeof(a)*(b)))){printf("memory error %s (%d byte)\n",c,sizeof(a)*(b));exit(1);}
-#define   realloc2(f,a,b,c)     if(!(f=(a *)realloc(f,sizeof(a)*(b)))){printf("memory error, %s (%d byte)\n",c,sizeof(a)*(b));exit(1);}
+#define   malloc2(f,a,b,c)     if(!(f=(a *)malloc(sizeof(a)*(b)))){printf("memory error %s (%zu byte)\n",c,(size_t)(sizeof(a)*(b)));exit(1);}
+#define   realloc2(f,a,b,c)     if(!(f=(a *)realloc(f,sizeof(a)*(b)))){printf("memory error, %s (%zu byte)\n",c,(size_t)(sizeof(a)*(b)));exit(1);}
 #define  free2(a)      {if(a){free(a);(a)=NULL;}a=0;}
 
 #define   fopen2r(f,a,c)     if(!(f=fopen(a,"r+"))){printf("%s:file open error %s\n",c,a);exit(1);}
@@ -113,6 +113,19 @@ int BITMASK_31[32] = { 0xfffffffe, 0xfffffffd, 0xfffffffb, 0xfffffff7,
                        0xfeffffff, 0xfdffffff, 0xfbffffff, 0xf7ffffff,
                        0xefffffff, 0xdfffffff, 0xbfffffff, 0x7fffffff };
 
+/* sums over the occurrences of the items in the database (its number of
+   elements, and the sizes of the buffers holding them). With LCM_COUNT_64
+   they are 64-bit, so a database may hold more than 2^31 occurrences.
+   Transactions and items are still numbered with int, so counts of
+   transactions (supports, N, n) stay int in both modes */
+#ifdef LCM_COUNT_64
+typedef long long COUNT_INT;
+#define COUNT_FMT "%lld"
+#else
+typedef int COUNT_INT;
+#define COUNT_FMT "%d"
+#endif
+
 
 #define LCMINT int
 
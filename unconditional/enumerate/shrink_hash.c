@@ -0,0 +1,221 @@
+#ifndef _shrink_hash_c_
+#define _shrink_hash_c_
+
+/* HASH-BASED DATABASE REDUCTION
+ * LCM_shrink merges the transactions of a conditional database which are identical up to the item the database is
+ * conditioned on (the whole transaction for the root database), by a radix sort of their items, one position at a
+ * time. With the optional argument -shrink hash, the same reduction is done in three sweeps instead:
+ * 	- each transaction gets a 64-bit fingerprint of its bitmap part and of its items below the conditioning item,
+ * 	- the transactions are grouped by fingerprint with an open-addressing table, checking the items of the
+ * 	  transactions with equal fingerprints, so collisions never merge different transactions. The first
+ * 	  transaction of each group is kept, and the others are added to it: multiplicity, items above the conditioning
+ * 	  item intersected for closed itemsets, and original transactions chained after its own,
+ * 	- the kept transactions are packed, with their lists of original transactions (transaction_keeping.c) and
+ * 	  their numbers of positives written in the new TRANS_LIST in the same sweep.
+ * The kept transactions stay in their order, and the original transactions of each group are listed in the order of
+ * the transactions merged, so the result only depends on the database.
+ * With -shrink_threads k, the databases of at least SHRINK_HASH_PARALLEL_MIN transactions are reduced by k threads:
+ * each fingerprints a slice of the transactions, then groups those whose fingerprint falls in its share, in its own
+ * table. Identical transactions have the same fingerprint, so no group spans two threads.
+ * */
+
+/* CODE DEPENDENCIES */
+#include<pthread.h>
+
+/* CONSTANT DEFINES */
+#define SHRINK_SORT 0
+#define SHRINK_HASH 1
+#define SHRINK_N 2
+// Maximum number of threads, and minimum number of transactions of a database reduced by several threads
+#define SHRINK_HASH_MAX_THREADS 64
+#define SHRINK_HASH_PARALLEL_MIN 32768
+
+/* FUNCTION DECLARATIONS */
+// Defined in trsact.c
+void LCM_trsact_and(QUEUE_INT *q, QUEUE_INT *qq, int *t);
+
+/* GLOBAL VARIABLES */
+// Reduction used by LCM_shrink, and the names of the reductions in the command line
+int shrink_mode = SHRINK_SORT;
+const char *shrink_names[SHRINK_N] = {"sort","hash"};
+// Number of threads given in the command line, and used for the database being reduced
+int shrink_threads = 1;
+int shrink_hash_P;
+// Fingerprint, number of items compared, and next transaction of its group (-1 for the last one), for each
+// transaction, and last transaction of the group of each kept transaction
+unsigned long long *shrink_hash_h;
+int *shrink_hash_len, *shrink_hash_next, *shrink_hash_last;
+// Open-addressing table of each thread, holding kept transactions (-1 for empty slots), and its allocated size
+int *shrink_hash_table[SHRINK_HASH_MAX_THREADS];
+int shrink_hash_table_siz[SHRINK_HASH_MAX_THREADS];
+// Database being reduced, and item it is conditioned on
+ARY *shrink_hash_T;
+int shrink_hash_max_item;
+
+/* INITIALISATION FUNCTIONS */
+
+/* Parse an optional argument -shrink or -shrink_threads of main. Returns 1 if the argument was consumed */
+int shrink_option(char *arg, char *value){
+	int i;
+	if(!strcmp(arg,"-shrink")){
+		for(i=0; i<SHRINK_N; i++) if(!strcmp(value,shrink_names[i])) break;
+		if(i == SHRINK_N){
+			fprintf(stderr,"Error in function shrink_option: unknown reduction %s\n",value);
+			exit(1);
+		}
+		shrink_mode = i;
+	}
+	else if(!strcmp(arg,"-shrink_threads")){
+		shrink_threads = atoi(value);
+		if((shrink_threads <= 0) || (shrink_threads > SHRINK_HASH_MAX_THREADS)){
+			fprintf(stderr,"Error in function shrink_option: the number of threads must be between 1 and %d\n",SHRINK_HASH_MAX_THREADS);
+			exit(1);
+		}
+	}
+	else return 0;
+	return 1;
+}
+
+/* Allocate the arrays of the transactions. Called by LCM_shrink_init with the size of the root database, the
+ * largest one reduced
+ * */
+void shrink_hash_init(int num){
+	if(shrink_mode != SHRINK_HASH) return;
+	shrink_hash_h = (unsigned long long *)malloc(num*sizeof(unsigned long long));
+	if(!shrink_hash_h){
+		fprintf(stderr,"Error in function shrink_hash_init: couldn't allocate memory for array shrink_hash_h\n");
+		exit(1);
+	}
+	shrink_hash_len = (int *)malloc(num*sizeof(int));
+	shrink_hash_next = (int *)malloc(num*sizeof(int));
+	shrink_hash_last = (int *)malloc(num*sizeof(int));
+	if(!shrink_hash_len || !shrink_hash_next || !shrink_hash_last){
+		fprintf(stderr,"Error in function shrink_hash_init: couldn't allocate memory for array shrink_hash_len\n");
+		exit(1);
+	}
+}
+
+/* CORE FUNCTIONS */
+
+/* Thread of the fingerprints: the bitmap part and the items below the conditioning item of a slice of the
+ * transactions are mixed into a 64-bit value
+ * */
+void *shrink_hash_fingerprint(void *arg){
+	int p = (int)(long)arg, t, t_end, num = shrink_hash_T->num;
+	unsigned long long h;
+	QUEUE *Q = shrink_hash_T->h;
+	QUEUE_INT *x;
+
+	t = (int)(((long long)num*p)/shrink_hash_P);
+	t_end = (int)(((long long)num*(p+1))/shrink_hash_P);
+	for(; t<t_end; t++){
+		h = ((unsigned long long)(unsigned int)Q[t].s + 1) * 0x9E3779B97F4A7C15ULL;
+		for(x=Q[t].q; *x<shrink_hash_max_item; x++) h = (h ^ (unsigned int)*x) * 0x100000001B3ULL;
+		h ^= h >> 29; h *= 0xBF58476D1CE4E5B9ULL; h ^= h >> 32;
+		shrink_hash_h[t] = h;
+		shrink_hash_len[t] = x - Q[t].q;
+	}
+	return NULL;
+}
+
+/* Thread of the groups: the transactions whose fingerprint falls in the share of the thread are merged into the
+ * first identical one
+ * */
+void *shrink_hash_group(void *arg){
+	int p = (int)(long)arg, t, r, n, num = shrink_hash_T->num, *table;
+	unsigned long long h, mask, i;
+	QUEUE *Q = shrink_hash_T->h;
+
+	// Table at most half full
+	for(t=n=0; t<num; t++) if((int)((shrink_hash_h[t] >> 40) % shrink_hash_P) == p) n++;
+	for(mask=1; mask < 2*(unsigned long long)n; mask <<= 1);
+	if(shrink_hash_table_siz[p] < (int)mask){
+		free(shrink_hash_table[p]);
+		shrink_hash_table[p] = (int *)malloc(mask*sizeof(int));
+		if(!shrink_hash_table[p]){
+			fprintf(stderr,"Error in function shrink_hash_group: couldn't allocate memory for array shrink_hash_table\n");
+			exit(1);
+		}
+		shrink_hash_table_siz[p] = mask;
+	}
+	table = shrink_hash_table[p];
+	memset(table,0xff,mask*sizeof(int));
+	mask--;
+
+	for(t=0; t<num; t++){
+		h = shrink_hash_h[t];
+		if((int)((h >> 40) % shrink_hash_P) != p) continue;
+		shrink_hash_next[t] = -1;
+		for(i=h&mask; (r=table[i]) >= 0; i=(i+1)&mask){
+			if((shrink_hash_h[r] != h) || (shrink_hash_len[r] != shrink_hash_len[t]) || (Q[r].s != Q[t].s)) continue;
+			if(memcmp(Q[r].q,Q[t].q,shrink_hash_len[t]*sizeof(QUEUE_INT))) continue;
+			// Same transaction as the kept transaction r
+			Q[r].end += Q[t].end; /* add multiplicity */
+			Q[t].end = 0;
+			shrink_hash_next[shrink_hash_last[r]] = t;
+			shrink_hash_last[r] = t;
+			if((LCM_PROBLEM == LCM_CLOSED) && (shrink_hash_max_item < LCM_Eend)){    /* for closed sets */
+				LCM_trsact_and(Q[r].q+shrink_hash_len[r], Q[t].q+shrink_hash_len[t], &(Q[r].t));
+				Q[r].t += shrink_hash_len[r];
+			}
+			break;
+		}
+		if(r < 0){
+			table[i] = t;
+			shrink_hash_last[t] = t;
+		}
+	}
+	return NULL;
+}
+
+/* Run f in shrink_hash_P threads, or in this one if there is only one */
+void shrink_hash_run(void *(*f)(void *)){
+	pthread_t threads[SHRINK_HASH_MAX_THREADS];
+	int p;
+
+	if(shrink_hash_P == 1){
+		f((void *)0);
+		return;
+	}
+	for(p=0; p<shrink_hash_P; p++){
+		if(pthread_create(threads+p,NULL,f,(void *)(long)p)){
+			fprintf(stderr,"Error in function shrink_hash_run: couldn't create thread %d\n",p);
+			exit(1);
+		}
+	}
+	for(p=0; p<shrink_hash_P; p++) pthread_join(threads[p],NULL);
+}
+
+/* Reduction of LCM_shrink with -shrink hash. Same arguments, but max_item is also the end of the comparison for the
+ * root database (max_item = LCM_Eend)
+ * */
+void LCM_shrink_hash(ARY *T, int max_item, TRANS_LIST *old_trans_list, TRANS_LIST *new_trans_list){
+	int t, j, u, n_items_cpy;
+	int *trans_list_buf = new_trans_list->list;
+	QUEUE *Q = T->h;
+
+	shrink_hash_T = T;
+	shrink_hash_max_item = max_item;
+	shrink_hash_P = (T->num >= SHRINK_HASH_PARALLEL_MIN) ? shrink_threads : 1;
+	shrink_hash_run(shrink_hash_fingerprint);
+	shrink_hash_run(shrink_hash_group);
+
+	// Pack the kept transactions, each followed by the original transactions of its group
+	for(t=j=0; t<T->num; t++){
+		if(Q[t].end <= 0) continue;
+		if(t != j) Q[j] = Q[t];
+		new_trans_list->ptr[j] = trans_list_buf;
+		new_trans_list->pos[j] = 0;
+		for(u=t; u>=0; u=shrink_hash_next[u]){
+			n_items_cpy = (u == (old_trans_list->siz2-1)) ? (old_trans_list->list + old_trans_list->siz1) -old_trans_list->ptr[u] : old_trans_list->ptr[u+1]-old_trans_list->ptr[u];
+			memcpy(trans_list_buf,old_trans_list->ptr[u],sizeof(int)*n_items_cpy);
+			trans_list_buf += n_items_cpy;
+			new_trans_list->pos[j] += old_trans_list->pos[u];
+		}
+		j++;
+	}
+	T->num = j;
+	new_trans_list->siz2 = j;
+}
+
+#endif
@@ -27,6 +27,72 @@ inline double logbincoeff(int n_, int k_){
 	return loggamma[n_] - loggamma[n_-k_] - loggamma[k_];
 }
 
+#include "bintail.c"
+
+
+/* PREFILTER
+ * Under the null hypothesis the two cell counts are independent binomials, A1 ~ Bin(n1,pi) and A0 ~ Bin(n0,pi)
+ * with pi = x/N, and the p-value of a table with probability p0 is P(p(A1,A0) <= p0). The prefilter bounds this
+ * probability from both sides before any exact computation:
+ *   upper bound: by Markov's inequality on p(A1,A0)^(-s), for any s in (0,1]
+ *        P(p(A1,A0) <= p0) <= p0^s * C_s(x) , C_s(x) = sum_{a1,a0} p(a1,a0)^(1-s)
+ *     s = 1 gives the simple bound (n1+1)(n0+1)p0 above, smaller values of s are much tighter for tables far
+ *     from the rejection boundary (the sum factorises over the two classes and only depends on x, so log C_s(x)
+ *     is computed once per margin for the PREFILTER_N_S values s = 1-2^(-k), k=1..PREFILTER_N_S, and every
+ *     further test costs a few flops);
+ *   lower bound: both binomial pmfs are unimodal, so every table whose cell counts are both further from the
+ *     modes than (a1,a0), on the same side, is at most as likely as the observed one, and
+ *        P(p(A1,A0) <= p0) >= P(A1 beyond a1) * P(A0 beyond a0)
+ * -log p0 is, up to terms of lower order, half the likelihood-ratio statistic G, so these are finite-sample
+ * versions of the tail bounds of the G-test, with no asymptotic approximation involved.
+ * */
+#define PREFILTER_N_S 4
+
+/* Compute log C_s(x) for all values of s of the prefilter */
+void prefilter_init_margin(int x_s){
+	double pi = (double)x_s / (double)N;
+	double log_pi = log(pi), log_1_pi = log(1.0 - pi);
+	double C1[PREFILTER_N_S], C0[PREFILTER_N_S], lp;
+	int a, k, n1 = n, n0 = N-n;
+	for(k=0; k<PREFILTER_N_S; k++){ C1[k] = 0; C0[k] = 0; }
+	// The terms are at most 1, so no rescaling is needed
+	for(a=0; a<=n1; a++){
+		lp = (a*log_pi) + ((n1-a)*log_1_pi) + logbincoeff(n1,a);
+		for(k=0; k<PREFILTER_N_S; k++) C1[k] += exp(ldexp(lp,-(k+1)));
+	}
+	for(a=0; a<=n0; a++){
+		lp = (a*log_pi) + ((n0-a)*log_1_pi) + logbincoeff(n0,a);
+		for(k=0; k<PREFILTER_N_S; k++) C0[k] += exp(ldexp(lp,-(k+1)));
+	}
+	for(k=0; k<PREFILTER_N_S; k++) prefilter_logC[x_s*PREFILTER_N_S + k] = log(C1[k]) + log(C0[k]);
+	prefilter_logC_flag[x_s] = 1;
+}
+
+/* Smallest of the upper bounds of the prefilter on the p-value, in log scale */
+double prefilter_upper_bound(int x_s , double p0){
+	double ub = 0, bound, s;
+	int k;
+	if(!prefilter_logC_flag[x_s]) prefilter_init_margin(x_s);
+	for(k=0; k<PREFILTER_N_S; k++){
+		s = 1.0 - ldexp(1.0,-(k+1));
+		bound = s*p0 + prefilter_logC[x_s*PREFILTER_N_S + k];
+		if(bound < ub) ub = bound;
+	}
+	return ub;
+}
+
+/* Tail of Bin(n_,pi) from a_ away from the mode: P(X >= a_) if a_ is not below the mode, P(X <= a_) otherwise */
+double prefilter_binomial_tail(int n_ , int a_ , double pi){
+	if(a_ >= (int)((n_+1)*pi)) return binomial_tail_upper(n_,a_,pi);
+	return binomial_tail_lower(n_,a_,pi);
+}
+
+/* Lower bound of the prefilter on the p-value */
+double prefilter_lower_bound(int x_s , int a_s){
+	double pi = (double)x_s / (double)N;
+	return prefilter_binomial_tail(n,a_s,pi) * prefilter_binomial_tail(N-n,x_s-a_s,pi);
+}
+
 
 int check_bounds(int x_s , int a_s , double epsilon , double *pvalue_lowerbound , double *pvalue_upperbound){
 
@@ -97,6 +163,28 @@ int check_bounds(int x_s , int a_s , double epsilon , double *pvalue_lowerbound
 			}
 
 
+			// check the bounds of the prefilter
+			double prefilter_ub = prefilter_upper_bound(x_s , p0);
+			if(prefilter_ub <= log(delta)){
+				if(DEBUG_L){fprintf(stderr,"Rejected with prefilter (%e)!\n",exp(prefilter_ub));}
+				count_number_of_prefilter_rejects++;
+				*pvalue_lowerbound = exp(p0);
+				*pvalue_upperbound = exp(prefilter_ub);
+				return 1;
+			}
+			double prefilter_lb = prefilter_lower_bound(x_s , a_s);
+			if(prefilter_lb > delta){
+				if(DEBUG_L){fprintf(stderr,"  not reject due to prefilter (%e)\n",prefilter_lb);}
+				count_number_of_prefilter_nonrejects++;
+				// As for the exact test, tables with margin x_s which are at least as likely are not significant either
+				if(probabilities_thr[x_s] > p0){
+					probabilities_thr[x_s] = p0;
+				}
+				*pvalue_lowerbound = prefilter_lb;
+				*pvalue_upperbound = exp(prefilter_ub);
+				return 1;
+			}
+
 			// check upper bound on approximation
 			/*double dn0 = (double)n0;
 			double dn1 = (double)n1;
@@ -548,7 +636,7 @@ double computeMinPvalueBarnard(int x_s , double pi_precision){
 
 		 // normalization factor
 		 //computeT(x_s , a_s , epsilon);
-		 int index = (a_s * (N-n)) + (x_s-a_s);
+		 long long index = ((long long)a_s * (N-n)) + (x_s-a_s);
 		 p_value = p_value - Tvalues[index];
 	 	 // convert to linear
 	 	 p_value = exp(p_value);
@@ -835,7 +923,7 @@ double computeMinPvalueBarnard(int x_s , double pi_precision){
 		 #ifdef USECONFINTERVALS
 			// normalization factor
 			computeT(x_s , a_s , epsilon);
-	 	 	int index = (a_s * (N-n)) + (x_s-a_s);
+	 	 	long long index = ((long long)a_s * (N-n)) + (x_s-a_s);
 			fprintf(stderr,"  negC (log10) = %f \n",p_value / log_10);
 			fprintf(stderr,"  negC = %f\n",exp(p_value));
 			fprintf(stderr,"   Tvalues[index] (log10) = %f \n",Tvalues[index] / log_10);
@@ -1086,14 +1174,14 @@ double computeMinPvalueBarnard(int x_s , double pi_precision){
 					if(DEBUG_B){fprintf(stderr,"  FINISHED updating hint_a0 = %d , side = %d , p_table = %f , p0 = %f \n",*hint_a0,side,p_table,p0);}
 				}
 			// we need to compute the tail of binomial distribution of variables a0 and parameter pi
-			// we use the incomplete regularized beta function
-			// Pr(X >= a0) when X ~ Bin(n0 , pi)
+			// Pr(X >= a0) when X ~ Bin(n0 , pi) (bintail.c, formerly incbeta(a0,n0-a0+1,pi))
 			if(DEBUG_B){fprintf(stderr,"  min_a0 = %d , max_a0 = %d , a0 of tail = %d \n",min_a0,max_a0,a0);}
 			if(side > 0){
-				bin_tail = incbeta((double)a0, (double)(n0-a0+1), pi);
+				bin_tail = binomial_tail_upper(n0,a0,pi);
 			}
 			else{
-				bin_tail = incbeta((double)(n0-a0+1) , (double)(a0+1), 1.0-pi);
+				// same tail as incbeta(n0-a0+1,a0+1,1-pi)
+				bin_tail = binomial_tail_lower(n0+1,a0,pi);
 			}
 			//bin_tail = max(bin_tail , TINY);
 			//bin_tail = min(bin_tail , 1.0-TINY);
@@ -1445,7 +1533,7 @@ double computeMinPvalueBarnard(int x_s , double pi_precision){
 				}
 				double right_tail_a1 = 0.0;
 				if(a1 >= 0 && a1 <=n1){
-					right_tail_a1 = incbeta((double)a1, (double)(n1-a1+1), pi);
+					right_tail_a1 = binomial_tail_upper(n1,a1,pi);
 				}
 				// the same decreasing a1
 				a1 = (int)(((double)(n1+1) * pi) + 0.5)-1;
@@ -1500,7 +1588,7 @@ double computeMinPvalueBarnard(int x_s , double pi_precision){
 				}
 				double left_tail_a1 = 0.0;
 				if(a1 >= 0 && a1 <=n1){
-					left_tail_a1 = incbeta((double)(n1-a1+1) , (double)a1, 1.0-pi);
+					left_tail_a1 = binomial_tail_lower(n1,a1-1,pi);
 				}
 				p_value = exp(p_value) + right_tail_a1 + left_tail_a1;
 				if(DEBUG_B){fprintf(stderr,"FAST numtables = %d \n",numtables);}